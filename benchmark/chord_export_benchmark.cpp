@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Exports a three hour rehearsal capture: saves it as a capture file,
+// then streams that to MusicXML and to a MIDI file as the command-line
+// tool does. Reports time, output size and the most heap the export had
+// in use at once, counted through operator new and delete. Files go to
+// the current directory and are removed afterwards.
+//
+//------------------------------------------------------------------------
+
+#include "chord_capture.h"
+#include "chord_export.h"
+#include "chord_timeline.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+using namespace Ursulean;
+
+//------------------------------------------------------------------------
+// Heap counter - live bytes, with a size header in front of each block
+//------------------------------------------------------------------------
+namespace {
+size_t liveBytes = 0;
+size_t peakBytes = 0;
+const size_t kHeaderSize = alignof(std::max_align_t);
+} // namespace
+
+void *operator new(size_t size) {
+  auto *block = static_cast<unsigned char *>(std::malloc(size + kHeaderSize));
+  if (!block)
+    throw std::bad_alloc();
+  *reinterpret_cast<size_t *>(block) = size;
+  liveBytes += size;
+  peakBytes = liveBytes > peakBytes ? liveBytes : peakBytes;
+  return block + kHeaderSize;
+}
+
+void operator delete(void *ptr) noexcept {
+  if (!ptr)
+    return;
+  auto *block = static_cast<unsigned char *>(ptr) - kHeaderSize;
+  liveBytes -= *reinterpret_cast<size_t *>(block);
+  std::free(block);
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+//------------------------------------------------------------------------
+// Two changes a second at 120 bpm, with a rest now and then
+void fillRehearsal(ChordTimeline &timeline, double hours) {
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int> pitchDist(36, 84);
+  double end = hours * 3600.0 * 2.0;
+  for (double position = 0.0; position < end; position += 1.0) {
+    NoteMask notes;
+    if (rng() % 16 != 0) {
+      while (notes.count() < 4)
+        notes.set(pitchDist(rng));
+    }
+    auto key = static_cast<KeySignature>((static_cast<int>(position) / 256) %
+                                         kNumKeySigs);
+    timeline.record(position, static_cast<int32_t>(position / 4.0), notes,
+                    key);
+  }
+}
+
+//------------------------------------------------------------------------
+long fileSize(const char *path) {
+  std::FILE *file = std::fopen(path, "rb");
+  if (!file)
+    return -1;
+  std::fseek(file, 0, SEEK_END);
+  long size = std::ftell(file);
+  std::fclose(file);
+  return size;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const double kHours = 3.0;
+  const char *kCapturePath = "chord_export_benchmark.chords";
+  const char *kMusicXmlPath = "chord_export_benchmark.musicxml";
+  const char *kMidiPath = "chord_export_benchmark.mid";
+
+  size_t timelineBytes = 0;
+  {
+    ChordTimeline timeline;
+    fillRehearsal(timeline, kHours);
+    timelineBytes = liveBytes;
+    std::printf("%.0f hours: %zu chords\n", kHours, timeline.size());
+    if (!writeChordCapture(timeline, kCapturePath)) {
+      std::printf("Can't write %s\n", kCapturePath);
+      return 1;
+    }
+  }
+
+  std::printf("%-10s %10s %12s %12s\n", "format", "ms", "KB out",
+              "peak KB heap");
+  bool ok = true;
+  for (int isMidi = 0; isMidi < 2; isMidi++) {
+    const char *path = isMidi ? kMidiPath : kMusicXmlPath;
+    size_t heapBefore = liveBytes;
+    peakBytes = liveBytes;
+
+    auto start = std::chrono::steady_clock::now();
+    ChordCaptureReader reader;
+    ExportOptions options;
+    bool written = reader.open(kCapturePath) &&
+                   (isMidi ? writeMidiFile(reader, options, path)
+                           : writeMusicXml(reader, options, path));
+    auto end = std::chrono::steady_clock::now();
+    ok = ok && written;
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::printf("%-10s %10.1f %12.0f %12.1f\n", isMidi ? "MIDI" : "MusicXML",
+                ms, fileSize(path) / 1024.0,
+                (peakBytes - heapBefore) / 1024.0);
+  }
+  std::printf("(the timeline itself took %.0f KB)\n", timelineBytes / 1024.0);
+
+  std::remove(kCapturePath);
+  std::remove(kMusicXmlPath);
+  std::remove(kMidiPath);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Measures the cost of naming the sounding chord: the raw pitch-class
+// table lookup, and identifyChord() on a full 128-note mask (fold to
+// pitch classes, table read, bass check) for typical voicing sizes.
+//
+//------------------------------------------------------------------------
+
+#include "chord_table.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+//------------------------------------------------------------------------
+template <typename Fn> double measureNanoseconds(Fn &&fn, int repetitions) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++)
+    fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+//------------------------------------------------------------------------
+std::vector<NoteMask> makeVoicings(size_t count, int numNotes) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pitchDist(36, 96);
+  std::vector<NoteMask> voicings(count);
+  for (auto &mask : voicings) {
+    while (mask.count() < numNotes)
+      mask.set(pitchDist(rng));
+  }
+  return voicings;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const int kRepetitions = 200;
+  const size_t kNumVoicings = 4096;
+
+  // Raw table reads over every pitch-class set
+  double tableNs = measureNanoseconds(
+      [&] {
+        for (unsigned set = 0; set < 4096; set++)
+          benchSink = benchSink + lookupChord(static_cast<uint16_t>(set)).root;
+      },
+      kRepetitions);
+  std::printf("%-24s %8.2f ns\n", "table lookup",
+              tableNs / (4096.0 * kRepetitions));
+
+  std::printf("%-24s %8s %10s\n", "identifyChord", "ns/call", "named");
+  const int noteCounts[] = {3, 4, 6, 10};
+  for (int numNotes : noteCounts) {
+    auto voicings = makeVoicings(kNumVoicings, numNotes);
+    size_t named = 0;
+    for (const auto &mask : voicings)
+      named += identifyChord(mask).isValid();
+
+    double ns = measureNanoseconds(
+        [&] {
+          for (const auto &mask : voicings)
+            benchSink = benchSink + identifyChord(mask).chord.quality;
+        },
+        kRepetitions);
+    std::printf("  %2d notes %13s %8.2f %9.1f%%\n", numNotes, "",
+                ns / (kNumVoicings * kRepetitions),
+                100.0 * named / kNumVoicings);
+  }
+
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
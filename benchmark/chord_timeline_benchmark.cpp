@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Fills a ChordTimeline with hours of playing, the way the controller
+// does: two chord changes a second at 120 bpm, each change arriving as a
+// few note mask words, with a 16 bar loop played over several times per
+// song section. Then times seeks to random positions (what a locate
+// costs) against a linear scan for the same chord, and reports the
+// timeline's memory use.
+//
+//------------------------------------------------------------------------
+
+#include "chord_timeline.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+//------------------------------------------------------------------------
+NoteMask randomChord(std::mt19937 &rng) {
+  std::uniform_int_distribution<int> pitchDist(36, 84);
+  NoteMask mask;
+  while (mask.count() < 4)
+    mask.set(pitchDist(rng));
+  return mask;
+}
+
+//------------------------------------------------------------------------
+// Returns the number of record() calls
+uint64_t playSession(ChordTimeline &timeline, double hours) {
+  const double kQuartersPerChange = 1.0; // Two a second at 120 bpm
+  const double kLoopQuarters = 64.0;     // 16 bars of 4/4
+  const int kPassesPerLoop = 3;
+  const int kWordsPerChange = 3;
+
+  std::mt19937 rng(7);
+  uint64_t numRecords = 0;
+  double sectionStart = 0.0;
+  double end = hours * 3600.0 * 2.0;
+  while (sectionStart < end) {
+    for (int pass = 0; pass < kPassesPerLoop; pass++) {
+      timeline.breakRecording(); // The host loops back
+      for (double q = 0.0; q < kLoopQuarters; q += kQuartersPerChange) {
+        double position = sectionStart + q;
+        NoteMask chord = randomChord(rng);
+        int32_t bar = static_cast<int32_t>(position / 4.0);
+        for (int w = 0; w < kWordsPerChange; w++) {
+          timeline.record(position, bar, chord, kCMajor);
+          numRecords++;
+        }
+      }
+    }
+    sectionStart += kLoopQuarters;
+  }
+  return numRecords;
+}
+
+//------------------------------------------------------------------------
+size_t linearSeek(const ChordTimeline &timeline, double position) {
+  size_t found = ChordTimeline::kNone;
+  for (size_t i = 0; i < timeline.size(); i++) {
+    if (timeline.getChord(i).position > position)
+      break;
+    found = i;
+  }
+  return found;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const int kNumSeeks = 2000;
+
+  std::printf("%-6s %10s %10s %12s %12s %12s\n", "hours", "chords", "KB",
+              "record ns", "seek ns", "scan ns");
+
+  const double sessionHours[] = {0.5, 2.0, 8.0};
+  for (double hours : sessionHours) {
+    ChordTimeline timeline;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t numRecords = playSession(timeline, hours);
+    auto end = std::chrono::steady_clock::now();
+    double recordNs =
+        std::chrono::duration<double, std::nano>(end - start).count() /
+        numRecords;
+
+    std::mt19937 rng(11);
+    double lastPosition = timeline.getChord(timeline.size() - 1).position;
+    std::uniform_real_distribution<double> positionDist(0.0, lastPosition);
+    std::vector<double> positions(kNumSeeks);
+    for (auto &position : positions)
+      position = positionDist(rng);
+
+    // Check both agree while timing them
+    uint64_t mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (double position : positions)
+      benchSink = benchSink + timeline.seek(position);
+    end = std::chrono::steady_clock::now();
+    double seekNs =
+        std::chrono::duration<double, std::nano>(end - start).count() /
+        kNumSeeks;
+
+    start = std::chrono::steady_clock::now();
+    for (double position : positions)
+      benchSink = benchSink + linearSeek(timeline, position);
+    end = std::chrono::steady_clock::now();
+    double scanNs =
+        std::chrono::duration<double, std::nano>(end - start).count() /
+        kNumSeeks;
+
+    for (double position : positions) {
+      if (timeline.seek(position) != linearSeek(timeline, position))
+        mismatches++;
+    }
+    if (mismatches) {
+      std::printf("seek disagrees with the scan %llu times\n",
+                  static_cast<unsigned long long>(mismatches));
+      return 1;
+    }
+
+    double kilobytes = timeline.size() * sizeof(TimelineChord) / 1024.0;
+    std::printf("%-6.1f %10zu %10.0f %12.1f %12.1f %12.1f\n", hours,
+                timeline.size(), kilobytes, recordNs, seekNs, scanNs);
+  }
+
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
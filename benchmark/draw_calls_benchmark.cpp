@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Counts the draw context calls (state changes plus draws) one frame of
+// the notation view takes when every item is drawn as geometry, i.e. the
+// static layer render or a redraw without the glyph atlas. Once item by
+// item, each with its own state and one call per line or ellipse, and
+// once the way NotationView does it: one state change and one call per
+// DrawBatcher batch, text last with its font set only when it changes.
+// Also times layout plus batching. No drawing happens here.
+//
+//------------------------------------------------------------------------
+
+#include "draw_batcher.h"
+#include "notation_layout.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+//------------------------------------------------------------------------
+std::vector<NoteMask> makeVoicings(size_t count, int numNotes) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pitchDist(21, 108);
+  std::vector<NoteMask> voicings(count);
+  for (auto &mask : voicings) {
+    while (mask.count() < numNotes)
+      mask.set(pitchDist(rng));
+  }
+  return voicings;
+}
+
+//------------------------------------------------------------------------
+// Stands in for CDrawContext, counting what BatchRenderer (or an item by
+// item renderer) would call on it
+struct CountingContext {
+  uint64_t stateChanges = 0;
+  uint64_t draws = 0;
+
+  uint64_t calls() const { return stateChanges + draws; }
+
+  void submit(const DrawBatcher &batcher, bool perPrimitive) {
+    for (size_t i = 0; i < batcher.getNumBatches(); i++) {
+      const DrawBatch &batch = batcher.getBatch(i);
+      // Fill color, or line width and frame color
+      stateChanges += batch.kind == DrawBatchKind::kFilledEllipses ? 1 : 2;
+      size_t numPrimitives = batch.segments.size() + batch.ellipses.size();
+      draws += perPrimitive ? numPrimitives : 1;
+    }
+  }
+  void drawOther(bool setState = true) {
+    if (setState)
+      stateChanges += 2; // Font and color, or fill color and mode
+    draws++;
+  }
+};
+
+//------------------------------------------------------------------------
+void drawItemByItem(const NotationLayout &layout, DrawBatcher &batcher,
+                    CountingContext &context) {
+  for (const DisplayItem &item : layout.getItems()) {
+    batcher.clear();
+    if (batcher.add(item, 0.0, 0.0))
+      context.submit(batcher, true);
+    else
+      context.drawOther();
+  }
+}
+
+//------------------------------------------------------------------------
+void drawBatched(const NotationLayout &layout, DrawBatcher &batcher,
+                 CountingContext &context) {
+  batcher.clear();
+  for (const DisplayItem &item : layout.getItems()) {
+    if (batcher.add(item, 0.0, 0.0) || item.type == DisplayItemType::kText)
+      continue;
+    context.submit(batcher, false); // Rects stay under what follows
+    batcher.clear();
+    context.drawOther();
+  }
+  context.submit(batcher, false);
+
+  const DisplayItem *lastText = nullptr;
+  for (const DisplayItem &item : layout.getItems()) {
+    if (item.type != DisplayItemType::kText)
+      continue;
+    bool sameFont = lastText && lastText->size == item.size &&
+                    lastText->bold == item.bold &&
+                    lastText->color.red == item.color.red &&
+                    lastText->color.green == item.color.green &&
+                    lastText->color.blue == item.color.blue &&
+                    lastText->color.alpha == item.color.alpha;
+    context.drawOther(!sameFont);
+    lastText = &item;
+  }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const int kRepetitions = 20;
+  const size_t kNumVoicings = 1024;
+  const double kWidth = 580.0; // The editor's notation view
+  const double kHeight = 390.0;
+
+  NotationLayout layout;
+  DrawBatcher batcher;
+  std::printf("%-8s %14s %14s %12s\n", "notes", "calls/item", "calls/batch",
+              "batch us");
+
+  const int noteCounts[] = {0, 1, 10, 88};
+  for (int numNotes : noteCounts) {
+    auto voicings = makeVoicings(kNumVoicings, numNotes);
+    CountingContext byItem;
+    CountingContext batched;
+    for (size_t v = 0; v < voicings.size(); v++) {
+      auto key = static_cast<KeySignature>(v % kNumKeySigs);
+      layout.layout(voicings[v], key, kWidth, kHeight);
+      drawItemByItem(layout, batcher, byItem);
+      drawBatched(layout, batcher, batched);
+    }
+
+    // Time layout plus batching per frame
+    auto start = std::chrono::steady_clock::now();
+    CountingContext timed;
+    for (int r = 0; r < kRepetitions; r++) {
+      for (size_t v = 0; v < voicings.size(); v++) {
+        auto key = static_cast<KeySignature>(v % kNumKeySigs);
+        layout.layout(voicings[v], key, kWidth, kHeight);
+        drawBatched(layout, batcher, timed);
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    benchSink = benchSink + timed.calls();
+
+    double frames = static_cast<double>(kNumVoicings);
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    std::printf("%-8d %14.1f %14.1f %12.3f\n", numNotes,
+                byItem.calls() / frames, batched.calls() / frames,
+                us / (frames * kRepetitions));
+  }
+
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Measures drawing the note layer (note heads, accidentals, ledger lines)
+// into an offscreen context, once as batched vector geometry and once
+// blitted from the GlyphAtlas, at 1x and 2x content scale. Needs
+// VSTGUI; times include the flush at endDraw().
+//
+//------------------------------------------------------------------------
+
+#include "batch_renderer.h"
+#include "draw_batcher.h"
+#include "glyph_atlas.h"
+#include "notation_layout.h"
+#include "vstgui/lib/coffscreencontext.h"
+#include "vstgui/lib/cpoint.h"
+#include "vstgui/lib/vstguiinit.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>
+#endif
+
+using namespace Ursulean;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+//------------------------------------------------------------------------
+std::vector<NoteMask> makeVoicings(size_t count, int numNotes) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pitchDist(21, 108);
+  std::vector<NoteMask> voicings(count);
+  for (auto &mask : voicings) {
+    while (mask.count() < numNotes)
+      mask.set(pitchDist(rng));
+  }
+  return voicings;
+}
+
+// Vector geometry goes out the way NotationView sends it
+DrawBatcher batcher;
+BatchRenderer renderer;
+
+//------------------------------------------------------------------------
+// Draws the note layer of every voicing once; returns the symbol count
+uint64_t drawFrames(VSTGUI::COffscreenContext *context,
+                    NotationLayout &layout, GlyphAtlas &atlas,
+                    const std::vector<NoteMask> &voicings, double width,
+                    double height, bool useAtlas) {
+  uint64_t numSymbols = 0;
+  for (const auto &mask : voicings) {
+    layout.layout(mask, kCMajor, width, height);
+    const auto &items = layout.getItems();
+
+    context->beginDraw();
+    context->setDrawMode(VSTGUI::kAntiAliasing);
+    context->setLineStyle(VSTGUI::kLineSolid);
+    for (size_t i = layout.getNumStaticItems(); i < items.size(); i++) {
+      // Symbols without a matching cell are drawn as geometry, as in the view
+      bool drawn = (useAtlas && atlas.draw(context, items[i], 0.0, 0.0)) ||
+                   batcher.add(items[i], 0.0, 0.0);
+      numSymbols += drawn ? 1 : 0;
+    }
+    renderer.draw(context, batcher);
+    batcher.clear();
+    context->endDraw();
+  }
+  return numSymbols;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+#if defined(_WIN32)
+  VSTGUI::init(GetModuleHandle(nullptr));
+#elif defined(__APPLE__)
+  VSTGUI::init(CFBundleGetMainBundle());
+#else
+  VSTGUI::init(nullptr);
+#endif
+
+  const int kRepetitions = 4;
+  const size_t kNumVoicings = 256;
+  const double kWidth = 580.0; // The editor's notation view
+  const double kHeight = 390.0;
+
+  NotationLayout layout;
+  std::printf("%-6s %-6s %12s %12s %10s\n", "scale", "notes", "vector us",
+              "atlas us", "symbols");
+
+  const double scaleFactors[] = {1.0, 2.0};
+  const int noteCounts[] = {1, 10, 88};
+  for (double scaleFactor : scaleFactors) {
+    auto context = VSTGUI::COffscreenContext::create(
+        VSTGUI::CPoint(kWidth, kHeight), scaleFactor);
+    if (!context) {
+      std::printf("No offscreen context at %.0fx\n", scaleFactor);
+      continue;
+    }
+
+    GlyphAtlas atlas;
+    layout.layout(NoteMask(), kCMajor, kWidth, kHeight);
+    if (!atlas.prepare(layout, scaleFactor)) {
+      std::printf("No glyph atlas at %.0fx\n", scaleFactor);
+      continue;
+    }
+
+    for (int numNotes : noteCounts) {
+      auto voicings = makeVoicings(kNumVoicings, numNotes);
+      double us[2] = {0.0, 0.0};
+      uint64_t numSymbols = 0;
+
+      for (int useAtlas = 0; useAtlas < 2; useAtlas++) {
+        // Warm up, then time
+        drawFrames(context, layout, atlas, voicings, kWidth, kHeight,
+                   useAtlas != 0);
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < kRepetitions; r++) {
+          numSymbols += drawFrames(context, layout, atlas, voicings, kWidth,
+                                   kHeight, useAtlas != 0);
+        }
+        auto end = std::chrono::steady_clock::now();
+        us[useAtlas] =
+            std::chrono::duration<double, std::micro>(end - start).count();
+      }
+      benchSink = benchSink + numSymbols;
+
+      double frames = static_cast<double>(kNumVoicings) * kRepetitions;
+      std::printf("%-6.0f %-6d %12.2f %12.2f %10.1f\n", scaleFactor, numNotes,
+                  us[0] / frames, us[1] / frames, numSymbols / frames / 2);
+    }
+  }
+
+  VSTGUI::exit();
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
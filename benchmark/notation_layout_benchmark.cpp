@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Measures NotationLayout on its own: the time to turn a note set, key and
+// view size into the display list, per chord, for typical voicing sizes.
+// Then the same through a LayoutCache, for a player cycling through a few
+// voicings, against the cache capacity. No drawing happens here.
+//
+//------------------------------------------------------------------------
+
+#include "layout_cache.h"
+#include "notation_layout.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+//------------------------------------------------------------------------
+std::vector<NoteMask> makeVoicings(size_t count, int numNotes) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pitchDist(21, 108);
+  std::vector<NoteMask> voicings(count);
+  for (auto &mask : voicings) {
+    while (mask.count() < numNotes)
+      mask.set(pitchDist(rng));
+  }
+  return voicings;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const int kRepetitions = 20;
+  const size_t kNumVoicings = 2048;
+  const double kWidth = 580.0; // The editor's notation view
+  const double kHeight = 390.0;
+
+  NotationLayout layout;
+  std::printf("%-10s %10s %12s\n", "notes", "us/chord", "items/chord");
+
+  // 88 is every key at once: the densest cluster there is
+  const int noteCounts[] = {0, 1, 3, 6, 10, 24, 88};
+  for (int numNotes : noteCounts) {
+    auto voicings = makeVoicings(kNumVoicings, numNotes);
+    size_t numItems = 0;
+
+    // Warm up, then time every key in turn
+    for (const auto &mask : voicings)
+      layout.layout(mask, kCMajor, kWidth, kHeight);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepetitions; r++) {
+      for (size_t v = 0; v < voicings.size(); v++) {
+        auto key = static_cast<KeySignature>(v % kNumKeySigs);
+        layout.layout(voicings[v], key, kWidth, kHeight);
+        numItems += layout.getItems().size();
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    benchSink = benchSink + numItems;
+
+    double layouts = static_cast<double>(kNumVoicings) * kRepetitions;
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    std::printf("%-10d %10.3f %12.1f\n", numNotes, us / layouts,
+                numItems / layouts);
+  }
+
+  // A song's worth of chords drawn from a small vocabulary of voicings
+  const size_t kNumChords = 8192;
+  const size_t kVocabulary = 12;
+  auto vocabulary = makeVoicings(kVocabulary, 4);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<size_t> chordDist(0, kVocabulary - 1);
+  std::vector<const NoteMask *> song(kNumChords);
+  for (auto &chord : song)
+    chord = &vocabulary[chordDist(rng)];
+
+  std::printf("\n%-10s %10s %10s\n", "capacity", "us/chord", "hit rate");
+  const size_t capacities[] = {1, 4, 8, 16, 32};
+  for (size_t capacity : capacities) {
+    LayoutCache cache(capacity);
+    size_t numItems = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepetitions; r++) {
+      for (const NoteMask *chord : song)
+        numItems += cache.layout(*chord, kCMajor, kWidth, kHeight)
+                        .getItems()
+                        .size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    benchSink = benchSink + numItems;
+
+    double layouts = static_cast<double>(kNumChords) * kRepetitions;
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    double lookups = static_cast<double>(cache.getHits() + cache.getMisses());
+    std::printf("%-10zu %10.3f %9.1f%%\n", capacity, us / layouts,
+                100.0 * cache.getHits() / lookups);
+  }
+
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Compares the audio-thread note bookkeeping of NoteState against the
+// std::set<int> + std::vector publish path it replaced. Both sides run the
+// same pre-generated MIDI stream, split into blocks; after every block the
+// current note set is published for the UI.
+//
+//------------------------------------------------------------------------
+
+#include "note_state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+struct BenchEvent {
+  int pitch;
+  int velocity; // 0 = note off
+};
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+//------------------------------------------------------------------------
+std::vector<BenchEvent> makeEventStream(size_t numEvents, int maxPolyphony) {
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> pitchDist(21, 108);
+  std::uniform_int_distribution<int> velocityDist(1, 127);
+
+  std::vector<BenchEvent> events;
+  events.reserve(numEvents);
+  std::vector<int> sounding;
+  while (events.size() < numEvents) {
+    bool release = !sounding.empty() &&
+                   (static_cast<int>(sounding.size()) >= maxPolyphony ||
+                    (rng() & 1));
+    if (release) {
+      size_t index = rng() % sounding.size();
+      events.push_back({sounding[index], 0});
+      sounding[index] = sounding.back();
+      sounding.pop_back();
+    } else {
+      int pitch = pitchDist(rng);
+      events.push_back({pitch, velocityDist(rng)});
+      sounding.push_back(pitch);
+    }
+  }
+  return events;
+}
+
+//------------------------------------------------------------------------
+template <typename Fn> double measureNanoseconds(Fn &&fn, int repetitions) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++)
+    fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+//------------------------------------------------------------------------
+void runSetPath(const std::vector<BenchEvent> &events, size_t eventsPerBlock) {
+  std::set<int> activeNotes;
+  for (size_t i = 0; i < events.size(); i += eventsPerBlock) {
+    size_t blockEnd = std::min(events.size(), i + eventsPerBlock);
+    for (size_t e = i; e < blockEnd; e++) {
+      if (events[e].velocity > 0)
+        activeNotes.insert(events[e].pitch);
+      else
+        activeNotes.erase(events[e].pitch);
+    }
+    std::vector<int> published(activeNotes.begin(), activeNotes.end());
+    benchSink = benchSink + published.size();
+  }
+}
+
+//------------------------------------------------------------------------
+void runNoteStatePath(const std::vector<BenchEvent> &events,
+                      size_t eventsPerBlock) {
+  NoteState activeNotes;
+  for (size_t i = 0; i < events.size(); i += eventsPerBlock) {
+    size_t blockEnd = std::min(events.size(), i + eventsPerBlock);
+    for (size_t e = i; e < blockEnd; e++) {
+      if (events[e].velocity > 0)
+        activeNotes.noteOn(events[e].pitch,
+                           static_cast<uint8_t>(events[e].velocity), 0,
+                           static_cast<int64_t>(e));
+      else
+        activeNotes.noteOff(events[e].pitch, static_cast<int64_t>(e));
+    }
+    NoteMask published = activeNotes.mask();
+    benchSink = benchSink + published.count();
+  }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const size_t kNumEvents = 1 << 18;
+  const int kRepetitions = 10;
+  const int polyphonies[] = {4, 10, 88};
+  const size_t blockSizes[] = {1, 16, 256};
+
+  std::printf("%-10s %-8s %14s %14s %9s\n", "polyphony", "ev/block",
+              "set ns/event", "mask ns/event", "speedup");
+
+  for (int polyphony : polyphonies) {
+    auto events = makeEventStream(kNumEvents, polyphony);
+    for (size_t eventsPerBlock : blockSizes) {
+      double setNs = measureNanoseconds(
+          [&] { runSetPath(events, eventsPerBlock); }, kRepetitions);
+      double maskNs = measureNanoseconds(
+          [&] { runNoteStatePath(events, eventsPerBlock); }, kRepetitions);
+
+      double perEvent = 1.0 / (static_cast<double>(kNumEvents) * kRepetitions);
+      std::printf("%-10d %-8zu %14.2f %14.2f %8.1fx\n", polyphony,
+                  eventsPerBlock, setNs * perEvent, maskNs * perEvent,
+                  setNs / maskNs);
+    }
+  }
+
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
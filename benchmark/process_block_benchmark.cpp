@@ -0,0 +1,256 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Times the processor's per-block work (NoteProcessor, which process() and
+// processMidiEvents() forward to) on synthetic MIDI workloads, without a
+// host. Each workload is pre-generated as a list of per-block event lists,
+// fed the same way process() feeds host events, with an output queue that
+// accepts every point like a host would.
+//
+// Reports the mean cost per block, event throughput and the tail of the
+// per-block latency distribution.
+//
+//------------------------------------------------------------------------
+
+#include "key_detection_thread.h"
+#include "note_processor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t benchSink = 0;
+
+// Accepts every point, as a host's output queue would
+class CountingOutput : public ControllerOutput {
+public:
+  bool sendNoteMaskWord(int, uint16_t word, int32_t) override {
+    points++;
+    lastWord = word;
+    return true;
+  }
+  bool sendKeySignature(KeySignature, int32_t) override {
+    points++;
+    return true;
+  }
+  bool sendTransition(const NoteTransition &transition, int32_t) override {
+    for (int part = 0; part < kNumTransitionParts; part++)
+      points += isTransitionPartSent(transition, part) ? 1 : 0;
+    return true;
+  }
+  bool sendLocate(double, int32_t) override {
+    points++;
+    return true;
+  }
+  uint16_t lastWord = 0;
+  uint64_t points = 0;
+};
+
+using EventList = std::vector<MidiNoteInput>;
+
+MidiNoteInput makeNote(int32_t offset, int pitch, bool isNoteOn) {
+  MidiNoteInput note;
+  note.sampleOffset = offset;
+  note.pitch = pitch;
+  note.velocity = isNoteOn ? 0.8f : 0.f;
+  note.isNoteOn = isNoteOn;
+  return note;
+}
+
+//------------------------------------------------------------------------
+// Workloads - each returns one event list per block
+//------------------------------------------------------------------------
+std::vector<EventList> emptyBlocks(int numBlocks, int32_t) {
+  return std::vector<EventList>(numBlocks);
+}
+
+std::vector<EventList> singleNotes(int numBlocks, int32_t blockSize) {
+  // A melody line: one note ends and the next starts every block
+  std::mt19937 rng(1);
+  std::vector<EventList> blocks(numBlocks);
+  int previous = -1;
+  for (auto &events : blocks) {
+    int32_t offset = static_cast<int32_t>(rng() % blockSize);
+    if (previous >= 0)
+      events.push_back(makeNote(offset, previous, false));
+    previous = 48 + static_cast<int>(rng() % 36);
+    events.push_back(makeNote(offset, previous, true));
+  }
+  return blocks;
+}
+
+std::vector<EventList> chords(int numBlocks, int32_t blockSize) {
+  // 10-note voicings replacing each other every block
+  std::mt19937 rng(2);
+  std::vector<EventList> blocks(numBlocks);
+  std::vector<int> previous;
+  for (auto &events : blocks) {
+    int32_t offset = static_cast<int32_t>(rng() % blockSize);
+    for (int pitch : previous)
+      events.push_back(makeNote(offset, pitch, false));
+    previous.clear();
+    int root = 36 + static_cast<int>(rng() % 24);
+    for (int i = 0; i < 10; i++)
+      previous.push_back(root + i * 4 + static_cast<int>(rng() % 2));
+    for (int pitch : previous)
+      events.push_back(makeNote(offset, pitch, true));
+  }
+  return blocks;
+}
+
+std::vector<EventList> clusters(int numBlocks, int32_t) {
+  // All 88 keys at once, then all released on the following block
+  std::vector<EventList> blocks(numBlocks);
+  for (int b = 0; b < numBlocks; b++) {
+    for (int pitch = 21; pitch <= 108; pitch++)
+      blocks[b].push_back(makeNote(0, pitch, b % 2 == 0));
+  }
+  return blocks;
+}
+
+std::vector<EventList> trills(int numBlocks, int32_t blockSize) {
+  // Two notes alternating every 64 samples, across block boundaries
+  const int32_t kPeriod = 64;
+  std::vector<EventList> blocks(numBlocks);
+  int64_t time = 0;
+  int64_t end = static_cast<int64_t>(numBlocks) * blockSize;
+  bool upper = false;
+  for (; time < end; time += kPeriod) {
+    auto &events = blocks[time / blockSize];
+    int32_t offset = static_cast<int32_t>(time % blockSize);
+    events.push_back(makeNote(offset, upper ? 62 : 64, false));
+    upper = !upper;
+    events.push_back(makeNote(offset, upper ? 62 : 64, true));
+  }
+  return blocks;
+}
+
+std::vector<EventList> sustained(int numBlocks, int32_t blockSize) {
+  // Pedalled arpeggios: notes pile up to ~60 voices and are only released
+  // together when the pedal lifts every 256 blocks
+  std::mt19937 rng(3);
+  std::vector<EventList> blocks(numBlocks);
+  std::vector<int> held;
+  for (int b = 0; b < numBlocks; b++) {
+    auto &events = blocks[b];
+    if (b % 256 == 255) {
+      for (int pitch : held)
+        events.push_back(makeNote(0, pitch, false));
+      held.clear();
+    }
+    for (int i = 0; i < 2; i++) {
+      int pitch = 28 + static_cast<int>(rng() % 72);
+      int32_t offset = static_cast<int32_t>((i * blockSize) / 2);
+      events.push_back(makeNote(offset, pitch, true));
+      held.push_back(pitch);
+    }
+  }
+  return blocks;
+}
+
+//------------------------------------------------------------------------
+struct Workload {
+  const char *name;
+  std::vector<EventList> (*build)(int numBlocks, int32_t blockSize);
+};
+
+const Workload workloads[] = {
+    {"empty", emptyBlocks},
+    {"single notes", singleNotes},
+    {"10-note chords", chords},
+    {"88-key clusters", clusters},
+    {"fast trills", trills},
+    {"sustain-heavy", sustained},
+};
+
+//------------------------------------------------------------------------
+struct BlockTimings {
+  double meanNs = 0.0;
+  double p50Ns = 0.0;
+  double p99Ns = 0.0;
+  double maxNs = 0.0;
+  double eventsPerSecond = 0.0;
+};
+
+BlockTimings runWorkload(const std::vector<EventList> &blocks,
+                         int32_t blockSize, int repetitions, bool autoKey) {
+  NoteProcessor processor;
+  processor.setAutoKey(autoKey);
+  KeyDetectionThread keyDetection(processor); // Never started
+  CountingOutput output;
+  std::vector<double> blockNs;
+  blockNs.reserve(blocks.size() * repetitions);
+
+  size_t numEvents = 0;
+  double totalNs = 0.0;
+  int64_t time = 0;
+  for (int r = 0; r < repetitions; r++) {
+    for (const auto &events : blocks) {
+      auto start = std::chrono::steady_clock::now();
+      processor.beginBlock(blockSize, true, time, &output);
+      for (const auto &note : events)
+        processor.addNote(note);
+      processor.endBlock();
+      auto end = std::chrono::steady_clock::now();
+
+      double ns = std::chrono::duration<double, std::nano>(end - start).count();
+      blockNs.push_back(ns);
+      totalNs += ns;
+      numEvents += events.size();
+      time += blockSize;
+
+      // What the detection thread does, untimed and not on the audio thread
+      if (autoKey)
+        keyDetection.process();
+    }
+  }
+  benchSink = benchSink + output.points;
+
+  BlockTimings timings;
+  timings.meanNs = totalNs / blockNs.size();
+  timings.eventsPerSecond = totalNs > 0.0 ? numEvents / (totalNs * 1e-9) : 0.0;
+  std::sort(blockNs.begin(), blockNs.end());
+  timings.p50Ns = blockNs[blockNs.size() / 2];
+  timings.p99Ns = blockNs[(blockNs.size() * 99) / 100];
+  timings.maxNs = blockNs.back();
+  return timings;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const int kNumBlocks = 4096;
+  const int kRepetitions = 8;
+  const int32_t blockSizes[] = {32, 128, 512, 2048};
+
+  std::printf("%-16s %6s %5s %12s %14s %10s %10s %10s\n", "workload",
+              "block", "key", "ns/block", "events/sec", "p50 ns", "p99 ns",
+              "max ns");
+
+  // Each workload with the key fixed, then with key detection running
+  for (const auto &workload : workloads) {
+    for (int32_t blockSize : blockSizes) {
+      auto blocks = workload.build(kNumBlocks, blockSize);
+      for (bool autoKey : {false, true}) {
+        // Warm up caches and branch history first
+        runWorkload(blocks, blockSize, 1, autoKey);
+        BlockTimings t = runWorkload(blocks, blockSize, kRepetitions, autoKey);
+        std::printf("%-16s %6d %5s %12.1f %14.3g %10.0f %10.0f %10.0f\n",
+                    workload.name, blockSize, autoKey ? "auto" : "fixed",
+                    t.meanNs, t.eventsPerSecond, t.p50Ns, t.p99Ns, t.maxNs);
+      }
+    }
+  }
+
+  return benchSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
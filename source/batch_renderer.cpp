@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "batch_renderer.h"
+#include "vstgui/lib/ccolor.h"
+#include "vstgui/lib/cpoint.h"
+#include "vstgui/lib/crect.h"
+
+#include <algorithm>
+
+namespace Ursulean {
+
+namespace {
+VSTGUI::CColor toColor(const LayoutColor &color) {
+  return VSTGUI::CColor(color.red, color.green, color.blue, color.alpha);
+}
+
+bool isSameGeometry(const std::vector<LayoutRect> &a,
+                    const std::vector<LayoutRect> &b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(),
+                    [](const LayoutRect &x, const LayoutRect &y) {
+                      return x.left == y.left && x.top == y.top &&
+                             x.right == y.right && x.bottom == y.bottom;
+                    });
+}
+} // namespace
+
+//------------------------------------------------------------------------
+void BatchRenderer::draw(VSTGUI::CDrawContext *context,
+                         const DrawBatcher &batcher) {
+  for (size_t i = 0; i < batcher.getNumBatches(); i++) {
+    const DrawBatch &batch = batcher.getBatch(i);
+
+    if (batch.kind == DrawBatchKind::kLines) {
+      lines.clear();
+      for (const LineSegment &segment : batch.segments) {
+        lines.emplace_back(VSTGUI::CPoint(segment.x1, segment.y1),
+                           VSTGUI::CPoint(segment.x2, segment.y2));
+      }
+      context->setLineWidth(batch.lineWidth);
+      context->setFrameColor(toColor(batch.color));
+      context->drawLines(lines);
+      continue;
+    }
+
+    VSTGUI::CGraphicsPath *path = getEllipsePath(context, i, batch);
+    if (!path)
+      continue;
+    if (batch.kind == DrawBatchKind::kFilledEllipses) {
+      context->setFillColor(toColor(batch.color));
+      context->drawGraphicsPath(path, VSTGUI::CDrawContext::kPathFilled);
+    } else {
+      context->setLineWidth(batch.lineWidth);
+      context->setFrameColor(toColor(batch.color));
+      context->drawGraphicsPath(path, VSTGUI::CDrawContext::kPathStroked);
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+VSTGUI::CGraphicsPath *
+BatchRenderer::getEllipsePath(VSTGUI::CDrawContext *context, size_t batchIndex,
+                              const DrawBatch &batch) {
+  if (ellipsePaths.size() <= batchIndex)
+    ellipsePaths.resize(batchIndex + 1);
+  EllipsePath &cached = ellipsePaths[batchIndex];
+  if (cached.path && isSameGeometry(cached.ellipses, batch.ellipses))
+    return cached.path;
+
+  cached.path = VSTGUI::owned(context->createGraphicsPath());
+  cached.ellipses.clear();
+  if (!cached.path)
+    return nullptr;
+  for (const LayoutRect &ellipse : batch.ellipses) {
+    cached.path->addEllipse(VSTGUI::CRect(ellipse.left, ellipse.top,
+                                          ellipse.right, ellipse.bottom));
+  }
+  cached.ellipses = batch.ellipses;
+  return cached.path;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,41 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "draw_batcher.h"
+#include "vstgui/lib/cdrawcontext.h"
+#include "vstgui/lib/cgraphicspath.h"
+#include <vector>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// BatchRenderer - Submits a DrawBatcher's batches to a draw context
+//
+// Each batch is one state change and one call: drawLines() for lines, one
+// graphics path for ellipses. The line list is kept between frames, and so
+// is each ellipse batch's path, rebuilt only when its ellipses move: a
+// redraw of the same notes creates no platform objects.
+//------------------------------------------------------------------------
+class BatchRenderer {
+public:
+  void draw(VSTGUI::CDrawContext *context, const DrawBatcher &batcher);
+
+private:
+  struct EllipsePath {
+    VSTGUI::SharedPointer<VSTGUI::CGraphicsPath> path;
+    std::vector<LayoutRect> ellipses; // What path holds
+  };
+
+  VSTGUI::CGraphicsPath *getEllipsePath(VSTGUI::CDrawContext *context,
+                                        size_t batchIndex,
+                                        const DrawBatch &batch);
+
+  VSTGUI::CDrawContext::LineList lines;
+  std::vector<EllipsePath> ellipsePaths; // By batch index
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "buffered_file.h"
+
+#include <cstring>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// BufferedFileWriter
+//------------------------------------------------------------------------
+bool BufferedFileWriter::open(const char *path) {
+  close();
+  file = std::fopen(path, "wb");
+  used = 0;
+  flushed = 0;
+  failed = file == nullptr;
+  return file != nullptr;
+}
+
+//------------------------------------------------------------------------
+bool BufferedFileWriter::close() {
+  if (!file)
+    return false;
+  flush();
+  failed = std::fclose(file) != 0 || failed;
+  file = nullptr;
+  return !failed;
+}
+
+//------------------------------------------------------------------------
+bool BufferedFileWriter::closeOrRemove(const char *path) {
+  if (close())
+    return true;
+  std::remove(path);
+  return false;
+}
+
+//------------------------------------------------------------------------
+void BufferedFileWriter::flush() {
+  if (used > 0 && file && std::fwrite(buffer, 1, used, file) != used)
+    failed = true;
+  flushed += used;
+  used = 0;
+}
+
+//------------------------------------------------------------------------
+void BufferedFileWriter::write(const void *data, size_t size) {
+  auto *bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    if (used == kBufferSize)
+      flush();
+    size_t count = kBufferSize - used < size ? kBufferSize - used : size;
+    std::memcpy(buffer + used, bytes, count);
+    used += count;
+    bytes += count;
+    size -= count;
+  }
+}
+
+//------------------------------------------------------------------------
+void BufferedFileWriter::write(const char *text) {
+  write(text, std::strlen(text));
+}
+
+//------------------------------------------------------------------------
+void BufferedFileWriter::writeInt(int64_t value) {
+  char digits[24];
+  size_t count = 0;
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value)
+                                 : static_cast<uint64_t>(value);
+  do {
+    digits[count++] = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0)
+    writeByte('-');
+  while (count > 0)
+    writeByte(static_cast<uint8_t>(digits[--count]));
+}
+
+//------------------------------------------------------------------------
+void BufferedFileWriter::patch(uint64_t offset, const void *data,
+                               size_t size) {
+  if (offset >= flushed) {
+    // Still in the buffer
+    std::memcpy(buffer + (offset - flushed), data, size);
+    return;
+  }
+
+  flush();
+  if (!file || std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0 ||
+      std::fwrite(data, 1, size, file) != size ||
+      std::fseek(file, 0, SEEK_END) != 0)
+    failed = true;
+}
+
+//------------------------------------------------------------------------
+// BufferedFileReader
+//------------------------------------------------------------------------
+bool BufferedFileReader::open(const char *path) {
+  close();
+  file = std::fopen(path, "rb");
+  used = 0;
+  filled = 0;
+  return file != nullptr;
+}
+
+//------------------------------------------------------------------------
+void BufferedFileReader::close() {
+  if (file)
+    std::fclose(file);
+  file = nullptr;
+}
+
+//------------------------------------------------------------------------
+bool BufferedFileReader::read(void *data, size_t size) {
+  auto *bytes = static_cast<uint8_t *>(data);
+  while (size > 0) {
+    if (used == filled) {
+      filled = file ? std::fread(buffer, 1, kBufferSize, file) : 0;
+      used = 0;
+      if (filled == 0)
+        return false;
+    }
+    size_t count = filled - used < size ? filled - used : size;
+    std::memcpy(bytes, buffer + used, count);
+    used += count;
+    bytes += count;
+    size -= count;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
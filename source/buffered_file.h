@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// BufferedFileWriter - Sequential file output through one fixed buffer
+//
+// Exports write many small pieces; they collect in the buffer and reach
+// the file in kBufferSize chunks, so memory stays the same whatever the
+// file size. A failed write is remembered and reported by close().
+//------------------------------------------------------------------------
+class BufferedFileWriter {
+public:
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  BufferedFileWriter() = default;
+  ~BufferedFileWriter() { close(); }
+  BufferedFileWriter(const BufferedFileWriter &) = delete;
+  BufferedFileWriter &operator=(const BufferedFileWriter &) = delete;
+
+  bool open(const char *path);
+  // Writes what is left; false if anything failed since open()
+  bool close();
+  // close(), deleting the file if that fails, so a full disk leaves no
+  // truncated file behind. path is the one given to open().
+  bool closeOrRemove(const char *path);
+  bool isOpen() const { return file != nullptr; }
+
+  void write(const void *data, size_t size);
+  void write(const char *text);
+  void writeByte(uint8_t value) {
+    if (used == kBufferSize)
+      flush();
+    buffer[used++] = value;
+  }
+  void writeInt(int64_t value); // Decimal
+
+  // Bytes written so far, and overwriting some of them (e.g. a length
+  // only known at the end)
+  uint64_t tell() const { return flushed + used; }
+  void patch(uint64_t offset, const void *data, size_t size);
+
+private:
+  void flush();
+
+  std::FILE *file = nullptr;
+  uint8_t buffer[kBufferSize];
+  size_t used = 0;
+  uint64_t flushed = 0;
+  bool failed = false;
+};
+
+//------------------------------------------------------------------------
+// BufferedFileReader - Sequential file input through one fixed buffer
+//------------------------------------------------------------------------
+class BufferedFileReader {
+public:
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  BufferedFileReader() = default;
+  ~BufferedFileReader() { close(); }
+  BufferedFileReader(const BufferedFileReader &) = delete;
+  BufferedFileReader &operator=(const BufferedFileReader &) = delete;
+
+  bool open(const char *path);
+  void close();
+
+  // False once fewer than size bytes are left
+  bool read(void *data, size_t size);
+
+private:
+  std::FILE *file = nullptr;
+  uint8_t buffer[kBufferSize];
+  size_t used = 0;
+  size_t filled = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
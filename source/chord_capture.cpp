@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "chord_capture.h"
+
+#include <cstring>
+
+namespace Ursulean {
+
+namespace {
+const char kCaptureTag[8] = {'N', 'C', 'H', 'C', 'H', 'R', 'D', '2'};
+const char kCaptureTagNoMeter[8] = {'N', 'C', 'H', 'C', 'H', 'R', 'D', '1'};
+const size_t kMeterSize = 16;
+const size_t kRecordSize = 32;
+
+uint64_t getDoubleBits(double value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double getBitsDouble(uint64_t bits) {
+  double value = 0.0;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void putLittleEndian(uint8_t *bytes, uint64_t value, int numBytes) {
+  for (int i = 0; i < numBytes; i++)
+    bytes[i] = static_cast<uint8_t>(value >> (i * 8));
+}
+
+uint64_t getLittleEndian(const uint8_t *bytes, int numBytes) {
+  uint64_t value = 0;
+  for (int i = numBytes - 1; i >= 0; i--)
+    value = (value << 8) | bytes[i];
+  return value;
+}
+} // namespace
+
+//------------------------------------------------------------------------
+bool writeChordCapture(const ChordTimeline &timeline, const char *path) {
+  BufferedFileWriter out;
+  if (!out.open(path))
+    return false;
+
+  out.write(kCaptureTag, sizeof(kCaptureTag));
+  const TimelineMeter &meter = timeline.getMeter();
+  uint8_t meterBytes[kMeterSize];
+  putLittleEndian(meterBytes, static_cast<uint32_t>(meter.beatsPerBar), 4);
+  putLittleEndian(meterBytes + 4, static_cast<uint32_t>(meter.beatUnit), 4);
+  putLittleEndian(meterBytes + 8, getDoubleBits(meter.tempo), 8);
+  out.write(meterBytes, kMeterSize);
+
+  for (size_t i = 0; i < timeline.size(); i++) {
+    const TimelineChord &chord = timeline.getChord(i);
+    uint8_t record[kRecordSize];
+    putLittleEndian(record, getDoubleBits(chord.position), 8);
+    putLittleEndian(record + 8, static_cast<uint32_t>(chord.bar), 4);
+    putLittleEndian(record + 12, static_cast<uint32_t>(chord.key), 4);
+    putLittleEndian(record + 16, chord.notes.words[0], 8);
+    putLittleEndian(record + 24, chord.notes.words[1], 8);
+    out.write(record, kRecordSize);
+  }
+  return out.closeOrRemove(path);
+}
+
+//------------------------------------------------------------------------
+bool ChordCaptureReader::open(const char *path) {
+  meter = TimelineMeter();
+  char tag[sizeof(kCaptureTag)];
+  if (!file.open(path) || !file.read(tag, sizeof(tag)))
+    return false;
+  if (std::memcmp(tag, kCaptureTagNoMeter, sizeof(tag)) == 0)
+    return true;
+  if (std::memcmp(tag, kCaptureTag, sizeof(tag)) != 0)
+    return false;
+
+  uint8_t meterBytes[kMeterSize];
+  if (!file.read(meterBytes, kMeterSize))
+    return false;
+  meter.beatsPerBar = static_cast<int32_t>(getLittleEndian(meterBytes, 4));
+  meter.beatUnit = static_cast<int32_t>(getLittleEndian(meterBytes + 4, 4));
+  meter.tempo = getBitsDouble(getLittleEndian(meterBytes + 8, 8));
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool ChordCaptureReader::next(TimelineChord &chord) {
+  uint8_t record[kRecordSize];
+  if (!file.read(record, kRecordSize))
+    return false;
+
+  chord.position = getBitsDouble(getLittleEndian(record, 8));
+  chord.bar = static_cast<int32_t>(getLittleEndian(record + 8, 4));
+  uint32_t key = static_cast<uint32_t>(getLittleEndian(record + 12, 4));
+  chord.key = key < kNumKeySigs ? static_cast<KeySignature>(key) : kCMajor;
+  chord.notes.words[0] = getLittleEndian(record + 16, 8);
+  chord.notes.words[1] = getLittleEndian(record + 24, 8);
+  return true;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
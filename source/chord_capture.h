@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "buffered_file.h"
+#include "chord_export.h"
+#include "chord_timeline.h"
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// Chord capture files
+//
+// A ChordTimeline as saved from the editor, for exporting later without
+// a host (see tools/chord_export_tool.cpp). An 8 byte tag and the
+// timeline's meter (beats, beat unit and tempo as an IEEE double), then one
+// 32 byte little-endian record per chord in position order: position
+// (IEEE double), bar, key, and the note mask low word first. False, and no
+// file, if it couldn't be written. Captures from before the meter was
+// saved still read, as 4/4 at 120 bpm.
+//------------------------------------------------------------------------
+bool writeChordCapture(const ChordTimeline &timeline, const char *path);
+
+// Reads a capture file record by record
+class ChordCaptureReader : public ChordSource {
+public:
+  // False if the file can't be read or isn't a capture
+  bool open(const char *path);
+  bool next(TimelineChord &chord) override;
+
+  // The meter the capture was recorded in, once open
+  const TimelineMeter &getMeter() const { return meter; }
+
+private:
+  BufferedFileReader file;
+  TimelineMeter meter;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "chord_column.h"
+#include "chord_table.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Ursulean {
+
+namespace {
+const LayoutColor kTickColor = {0, 0, 0, 255};
+const LayoutColor kGuideColor = {200, 200, 200, 255}; // Dividers, middle C
+
+const int kLowestNote = 21; // A0 to C8, the piano's range
+const int kHighestNote = 108;
+
+void addLine(DrawBatcher &batcher, double x1, double y1, double x2, double y2,
+             double lineWidth, const LayoutColor &color) {
+  DisplayItem line;
+  line.type = DisplayItemType::kLine;
+  line.color = color;
+  line.left = x1;
+  line.top = y1;
+  line.right = x2;
+  line.bottom = y2;
+  line.lineWidth = lineWidth;
+  batcher.add(line, 0.0, 0.0);
+}
+} // namespace
+
+//------------------------------------------------------------------------
+void layoutChordColumn(DrawBatcher &batcher, const NoteMask &notes,
+                       const VSTGUI::CRect &column, double rollTop,
+                       double rollBottom) {
+  double noteHeight =
+      (rollBottom - rollTop) / (kHighestNote - kLowestNote + 1);
+  auto noteY = [&](int note) {
+    note = std::max(kLowestNote, std::min(kHighestNote, note));
+    return rollBottom - (note - kLowestNote + 0.5) * noteHeight;
+  };
+
+  double left = column.left + 12.0;
+  double right = column.right - 12.0;
+  addLine(batcher, column.left, column.top, column.left, column.bottom, 1.0,
+          kGuideColor);
+  addLine(batcher, left, noteY(60), right, noteY(60), 1.0, kGuideColor);
+  notes.forEach([&](int note) {
+    addLine(batcher, left, noteY(note), right, noteY(note), 1.5, kTickColor);
+  });
+}
+
+//------------------------------------------------------------------------
+void formatChordColumnSymbol(const NoteMask &notes, KeySignature key,
+                             char *symbol, size_t size) {
+  ChordName chord = identifyChord(notes);
+  if (!notes.any())
+    std::snprintf(symbol, size, "rest");
+  else if (chord.isValid())
+    formatChordSymbol(chord, usesFlats(key), symbol, size);
+  else
+    std::snprintf(symbol, size, "%d notes", notes.count());
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
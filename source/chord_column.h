@@ -0,0 +1,31 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "draw_batcher.h"
+#include "key_signature.h"
+#include "note_state.h"
+#include "vstgui/lib/crect.h"
+#include <cstddef>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// Chord columns, as the history and timeline strips draw them
+//------------------------------------------------------------------------
+
+// Adds a divider on the column's left edge, a middle C guide and a tick
+// per note, the keyboard range spread from rollBottom up to rollTop
+void layoutChordColumn(DrawBatcher &batcher, const NoteMask &notes,
+                       const VSTGUI::CRect &column, double rollTop,
+                       double rollBottom);
+
+// The chord symbol, or the number of notes if it isn't a known chord,
+// or "rest"
+void formatChordColumnSymbol(const NoteMask &notes, KeySignature key,
+                             char *symbol, size_t size);
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,558 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "chord_export.h"
+#include "buffered_file.h"
+#include "note_spelling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Ursulean {
+
+namespace {
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+  int64_t quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+// Quarter notes in one bar
+double getQuartersPerBar(const ExportOptions &options) {
+  return options.beatsPerBar * 4.0 / options.beatUnit;
+}
+
+//------------------------------------------------------------------------
+// MusicXML
+//------------------------------------------------------------------------
+const int kDivisions = 4; // Per quarter note: positions snap to 16ths
+
+// Written note values, longest first, in divisions
+struct NoteValue {
+  int duration;
+  const char *type;
+  bool dotted;
+};
+const NoteValue kNoteValues[] = {
+    {16, "whole", false},  {12, "half", true}, {8, "half", false},
+    {6, "quarter", true},  {4, "quarter", false}, {3, "eighth", true},
+    {2, "eighth", false},  {1, "16th", false}};
+
+const char kStepNames[7] = {'C', 'D', 'E', 'F', 'G', 'A', 'B'};
+const int kStepPitches[7] = {0, 2, 4, 5, 7, 9, 11};
+
+// One stretch of a chord inside a bar, in divisions from the song start
+struct BarPiece {
+  int64_t start = 0;
+  int64_t length = 0;
+  NoteMask notes;
+  KeySignature key = kCMajor;
+  NoteMask tiedIn;  // Notes held from the piece before
+  NoteMask tiedOut; // Notes held into the piece after
+};
+
+//------------------------------------------------------------------------
+// MusicXmlWriter - Collects one bar of pieces at a time and writes it as
+// a measure of the grand staff, treble then bass
+class MusicXmlWriter {
+public:
+  MusicXmlWriter(BufferedFileWriter &out, const ExportOptions &options)
+      : out(out), options(options),
+        barLength(static_cast<int64_t>(getQuartersPerBar(options) *
+                                       kDivisions)) {
+    pieces.reserve(static_cast<size_t>(barLength));
+  }
+
+  int64_t getBarLength() const { return barLength; }
+
+  void begin();
+  // Back to back stretches, [start, end) in divisions
+  void add(int64_t start, int64_t end, const NoteMask &notes,
+           KeySignature key);
+  void finish();
+
+private:
+  void writeBar();
+  void writeAttributes(KeySignature key, bool full);
+  void writeStaff(int staff);
+  void writeNote(int pitch, KeySignature key, const NoteValue &value,
+                 int staff, bool isChord, bool tieStop, bool tieStart,
+                 bool showAccidental);
+  void writeRest(const NoteValue &value, int staff);
+
+  BufferedFileWriter &out;
+  const ExportOptions &options;
+  int64_t barLength;
+
+  bool hasBar = false;
+  int64_t bar = 0; // Index of the bar being collected
+  std::vector<BarPiece> pieces;
+  bool hasWrittenKey = false;
+  KeySignature writtenKey = kCMajor;
+};
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::begin() {
+  out.write("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+            "<!DOCTYPE score-partwise PUBLIC \"-//Recordare//DTD MusicXML "
+            "4.0 Partwise//EN\" \"http://www.musicxml.org/dtds/"
+            "partwise.dtd\">\n"
+            "<score-partwise version=\"4.0\">\n"
+            "  <part-list>\n"
+            "    <score-part id=\"P1\"><part-name>Chords</part-name>"
+            "</score-part>\n"
+            "  </part-list>\n"
+            "  <part id=\"P1\">\n");
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::add(int64_t start, int64_t end, const NoteMask &notes,
+                         KeySignature key) {
+  // Notes the previous chord already holds are tied over, as the MIDI file
+  // sustains them
+  NoteMask tiedIn;
+  if (hasBar && !pieces.empty()) {
+    BarPiece &previous = pieces.back();
+    tiedIn = notes & previous.notes;
+    previous.tiedOut = tiedIn;
+  }
+
+  while (start < end) {
+    int64_t pieceBar = floorDiv(start, barLength);
+    if (!hasBar || pieceBar != bar) {
+      if (hasBar)
+        writeBar();
+      pieces.clear();
+      hasBar = true;
+      bar = pieceBar;
+
+      // Only the first chord can start after its bar line
+      if (start > bar * barLength) {
+        BarPiece rest;
+        rest.start = bar * barLength;
+        rest.length = start - rest.start;
+        rest.key = key;
+        pieces.push_back(rest);
+      }
+    }
+
+    BarPiece piece;
+    int64_t pieceEnd = std::min(end, (bar + 1) * barLength);
+    piece.start = start;
+    piece.length = pieceEnd - start;
+    piece.notes = notes;
+    piece.key = key;
+    piece.tiedIn = tiedIn;
+    if (pieceEnd < end)
+      piece.tiedOut = notes;
+    pieces.push_back(piece);
+
+    start = pieceEnd;
+    tiedIn = notes;
+  }
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::finish() {
+  if (hasBar)
+    writeBar();
+  out.write("  </part>\n"
+            "</score-partwise>\n");
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::writeBar() {
+  out.write("    <measure number=\"");
+  out.writeInt(bar + 1);
+  out.write("\">\n");
+
+  if (!hasWrittenKey) {
+    writtenKey = pieces.front().key;
+    writeAttributes(writtenKey, true);
+    hasWrittenKey = true;
+  }
+
+  writeStaff(1);
+  out.write("      <backup><duration>");
+  out.writeInt(barLength);
+  out.write("</duration></backup>\n");
+  writeStaff(2);
+
+  out.write("    </measure>\n");
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::writeAttributes(KeySignature key, bool full) {
+  int fifths = usesFlats(key) ? -getNumAccidentals(key)
+                              : getNumAccidentals(key);
+  out.write("      <attributes>");
+  if (full) {
+    out.write("<divisions>");
+    out.writeInt(kDivisions);
+    out.write("</divisions>");
+  }
+  out.write("<key><fifths>");
+  out.writeInt(fifths);
+  out.write("</fifths></key>");
+  if (full) {
+    out.write("<time><beats>");
+    out.writeInt(options.beatsPerBar);
+    out.write("</beats><beat-type>");
+    out.writeInt(options.beatUnit);
+    out.write("</beat-type></time><staves>2</staves>"
+              "<clef number=\"1\"><sign>G</sign><line>2</line></clef>"
+              "<clef number=\"2\"><sign>F</sign><line>4</line></clef>");
+  }
+  out.write("</attributes>\n");
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::writeStaff(int staff) {
+  // Middle C and up on the treble staff, as on the view's grand staff
+  for (const BarPiece &piece : pieces) {
+    // Key changes go where they happen; written once, they hold for both
+    // staves
+    if (staff == 1 && piece.key != writtenKey) {
+      writeAttributes(piece.key, false);
+      writtenKey = piece.key;
+    }
+
+    NoteMask staffNotes;
+    piece.notes.forEach([&](int pitch) {
+      bool isTreble = spellNote(piece.key, pitch).staffStep >= 0;
+      if (isTreble == (staff == 1))
+        staffNotes.set(pitch);
+    });
+
+    // Lengths no single note value has become tied notes
+    int64_t remaining = piece.length;
+    bool isFirst = true;
+    while (remaining > 0) {
+      const NoteValue *value = &kNoteValues[0];
+      while (value->duration > remaining)
+        value++;
+      remaining -= value->duration;
+
+      if (!staffNotes.any()) {
+        writeRest(*value, staff);
+      } else {
+        bool isChord = false;
+        staffNotes.forEach([&](int pitch) {
+          bool tieStop = piece.tiedIn.test(pitch) || !isFirst;
+          bool tieStart = piece.tiedOut.test(pitch) || remaining > 0;
+          writeNote(pitch, piece.key, *value, staff, isChord, tieStop,
+                    tieStart, !tieStop);
+          isChord = true;
+        });
+      }
+      isFirst = false;
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::writeNote(int pitch, KeySignature key,
+                               const NoteValue &value, int staff,
+                               bool isChord, bool tieStop, bool tieStart,
+                               bool showAccidental) {
+  const NoteSpelling &spelling = spellNote(key, pitch);
+  int step = static_cast<int>(floorDiv(spelling.staffStep, 7) * 7);
+  int letter = spelling.staffStep - step;
+  int octave = 4 + step / 7;
+  int alter = pitch - (12 * (octave + 1) + kStepPitches[letter]);
+
+  out.write(isChord ? "      <note><chord/><pitch><step>"
+                    : "      <note><pitch><step>");
+  out.writeByte(static_cast<uint8_t>(kStepNames[letter]));
+  out.write("</step>");
+  if (alter != 0) {
+    out.write("<alter>");
+    out.writeInt(alter);
+    out.write("</alter>");
+  }
+  out.write("<octave>");
+  out.writeInt(octave);
+  out.write("</octave></pitch><duration>");
+  out.writeInt(value.duration);
+  out.write("</duration>");
+  if (tieStop)
+    out.write("<tie type=\"stop\"/>");
+  if (tieStart)
+    out.write("<tie type=\"start\"/>");
+  out.write("<voice>");
+  out.writeInt(staff);
+  out.write("</voice><type>");
+  out.write(value.type);
+  out.write(value.dotted ? "</type><dot/>" : "</type>");
+
+  if (showAccidental && spelling.accidental == kSharpAccidental)
+    out.write("<accidental>sharp</accidental>");
+  else if (showAccidental && spelling.accidental == kFlatAccidental)
+    out.write("<accidental>flat</accidental>");
+  else if (showAccidental && spelling.accidental == kNaturalAccidental)
+    out.write("<accidental>natural</accidental>");
+
+  out.write("<staff>");
+  out.writeInt(staff);
+  out.write("</staff>");
+  if (tieStop || tieStart) {
+    out.write("<notations>");
+    if (tieStop)
+      out.write("<tied type=\"stop\"/>");
+    if (tieStart)
+      out.write("<tied type=\"start\"/>");
+    out.write("</notations>");
+  }
+  out.write("</note>\n");
+}
+
+//------------------------------------------------------------------------
+void MusicXmlWriter::writeRest(const NoteValue &value, int staff) {
+  out.write("      <note><rest/><duration>");
+  out.writeInt(value.duration);
+  out.write("</duration><voice>");
+  out.writeInt(staff);
+  out.write("</voice><type>");
+  out.write(value.type);
+  out.write(value.dotted ? "</type><dot/>" : "</type>");
+  out.write("<staff>");
+  out.writeInt(staff);
+  out.write("</staff></note>\n");
+}
+
+//------------------------------------------------------------------------
+// Standard MIDI File
+//------------------------------------------------------------------------
+const int kTicksPerQuarter = 480;
+const uint8_t kVelocity = 80; // Velocities aren't captured
+
+void writeBigEndian(BufferedFileWriter &out, uint32_t value, int numBytes) {
+  for (int i = numBytes - 1; i >= 0; i--)
+    out.writeByte(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+// Four bytes of 7 bits at most
+const uint32_t kMaxVariableLength = 0x0FFFFFFF;
+
+// Values above kMaxVariableLength are written as kMaxVariableLength
+void writeVariableLength(BufferedFileWriter &out, uint32_t value) {
+  value = std::min(value, kMaxVariableLength);
+  uint8_t bytes[4];
+  int count = 0;
+  do {
+    bytes[count++] = static_cast<uint8_t>(value & 0x7F);
+    value >>= 7;
+  } while (value > 0);
+  while (count > 1)
+    out.writeByte(bytes[--count] | 0x80);
+  out.writeByte(bytes[0]);
+}
+
+//------------------------------------------------------------------------
+// Track events with their delta times
+class MidiTrackWriter {
+public:
+  explicit MidiTrackWriter(BufferedFileWriter &out) : out(out) {}
+
+  void meta(int64_t tick, uint8_t type, const uint8_t *data, uint8_t size) {
+    delta(tick);
+    out.writeByte(0xFF);
+    out.writeByte(type);
+    out.writeByte(size);
+    out.write(data, size);
+  }
+
+  void note(int64_t tick, int pitch, uint8_t velocity) {
+    delta(tick);
+    out.writeByte(0x90); // Note on, channel 1; velocity 0 is a note off
+    out.writeByte(static_cast<uint8_t>(pitch));
+    out.writeByte(velocity);
+  }
+
+  // Note offs for the notes in from, note ons for the ones in to
+  void change(int64_t tick, const NoteMask &from, const NoteMask &to) {
+    NoteMask changed = from ^ to;
+    (from & changed).forEach([&](int pitch) { note(tick, pitch, 0); });
+    (to & changed).forEach([&](int pitch) { note(tick, pitch, kVelocity); });
+  }
+
+  void key(int64_t tick, KeySignature key) {
+    int fifths = usesFlats(key) ? -getNumAccidentals(key)
+                                : getNumAccidentals(key);
+    uint8_t data[2] = {static_cast<uint8_t>(static_cast<int8_t>(fifths)), 0};
+    meta(tick, 0x59, data, 2);
+  }
+
+private:
+  // A gap longer than a delta can be (over 77 hours at 120 bpm) is
+  // shortened, and everything after it moves up by as much
+  void delta(int64_t tick) {
+    tick -= removedTicks;
+    if (tick - lastTick > kMaxVariableLength) {
+      removedTicks += tick - lastTick - kMaxVariableLength;
+      tick = lastTick + kMaxVariableLength;
+    }
+    writeVariableLength(out, static_cast<uint32_t>(tick - lastTick));
+    lastTick = tick;
+  }
+
+  BufferedFileWriter &out;
+  int64_t lastTick = 0;
+  int64_t removedTicks = 0; // Taken out of gaps that were too long
+};
+
+} // namespace
+
+//------------------------------------------------------------------------
+bool isValidExportOptions(const ExportOptions &options) {
+  // A MIDI tempo is 24 bits of microseconds per quarter note
+  const double kMicrosPerMinute = 60000000.0;
+  const double kMinTempo = kMicrosPerMinute / 0xFFFFFF; // About 3.6 bpm
+
+  int unit = options.beatUnit;
+  bool isPowerOfTwo = unit > 0 && unit <= 16 && (unit & (unit - 1)) == 0;
+  return isPowerOfTwo && options.beatsPerBar > 0 &&
+         options.beatsPerBar <= 64 && options.tempo >= kMinTempo &&
+         options.tempo <= kMicrosPerMinute;
+}
+
+//------------------------------------------------------------------------
+ExportOptions getExportOptions(const TimelineMeter &meter) {
+  ExportOptions options;
+  options.beatsPerBar = meter.beatsPerBar;
+  options.beatUnit = meter.beatUnit;
+  if (!isValidExportOptions(options)) {
+    options.beatsPerBar = ExportOptions().beatsPerBar;
+    options.beatUnit = ExportOptions().beatUnit;
+  }
+  options.tempo = meter.tempo;
+  if (!isValidExportOptions(options))
+    options.tempo = ExportOptions().tempo;
+  return options;
+}
+
+//------------------------------------------------------------------------
+bool writeMusicXml(ChordSource &source, const ExportOptions &options,
+                   const char *path) {
+  if (!isValidExportOptions(options))
+    return false;
+  BufferedFileWriter out;
+  if (!out.open(path))
+    return false;
+
+  MusicXmlWriter writer(out, options);
+  writer.begin();
+
+  // Positions before the song start (pre-roll) are moved up to it, as in
+  // the MIDI file
+  auto toGrid = [](double position) {
+    return static_cast<int64_t>(
+        std::llround(std::max(position, 0.0) * kDivisions));
+  };
+
+  TimelineChord chord;
+  if (!source.next(chord)) {
+    writer.add(0, writer.getBarLength(), NoteMask(), kCMajor); // Empty bar
+  } else {
+    // A chord that snaps to where the next one starts never sounds
+    int64_t start = toGrid(chord.position);
+    TimelineChord next;
+    bool hasChord = true;
+    while (hasChord) {
+      bool hasNext = source.next(next);
+      int64_t barLength = writer.getBarLength();
+      int64_t end = hasNext ? toGrid(next.position)
+                            : (floorDiv(start, barLength) + 1) * barLength;
+      if (end > start) {
+        writer.add(start, end, chord.notes, chord.key);
+        start = end;
+      }
+      chord = next;
+      hasChord = hasNext;
+    }
+  }
+
+  writer.finish();
+  return out.closeOrRemove(path);
+}
+
+//------------------------------------------------------------------------
+bool writeMidiFile(ChordSource &source, const ExportOptions &options,
+                   const char *path) {
+  if (!isValidExportOptions(options))
+    return false;
+  BufferedFileWriter out;
+  if (!out.open(path))
+    return false;
+
+  // Header: format 0, one track
+  out.write("MThd", 4);
+  writeBigEndian(out, 6, 4);
+  writeBigEndian(out, 0, 2);
+  writeBigEndian(out, 1, 2);
+  writeBigEndian(out, kTicksPerQuarter, 2);
+
+  // The track length is filled in at the end
+  out.write("MTrk", 4);
+  uint64_t lengthOffset = out.tell();
+  writeBigEndian(out, 0, 4);
+  uint64_t trackStart = out.tell();
+
+  MidiTrackWriter track(out);
+  auto microsPerQuarter = static_cast<uint32_t>(60000000.0 / options.tempo);
+  uint8_t tempo[3] = {static_cast<uint8_t>(microsPerQuarter >> 16),
+                      static_cast<uint8_t>(microsPerQuarter >> 8),
+                      static_cast<uint8_t>(microsPerQuarter)};
+  track.meta(0, 0x51, tempo, 3);
+
+  uint8_t beatUnitPower = 0;
+  while ((1 << beatUnitPower) < options.beatUnit)
+    beatUnitPower++;
+  uint8_t timeSignature[4] = {static_cast<uint8_t>(options.beatsPerBar),
+                              beatUnitPower, 24, 8};
+  track.meta(0, 0x58, timeSignature, 4);
+
+  // Positions before the song start (pre-roll) are moved up to it; there
+  // are no negative ticks
+  NoteMask sounding;
+  bool hasKey = false;
+  KeySignature key = kCMajor;
+  int64_t tick = 0;
+  double lastPosition = 0.0;
+  TimelineChord chord;
+  while (source.next(chord)) {
+    double position = std::max(chord.position, 0.0);
+    tick = std::max(tick, static_cast<int64_t>(std::llround(
+                              position * kTicksPerQuarter)));
+    lastPosition = position;
+    if (!hasKey || chord.key != key) {
+      track.key(tick, chord.key);
+      hasKey = true;
+      key = chord.key;
+    }
+    track.change(tick, sounding, chord.notes);
+    sounding = chord.notes;
+  }
+
+  // The last chord ends with its bar
+  double quartersPerBar = getQuartersPerBar(options);
+  double barEnd =
+      (std::floor(lastPosition / quartersPerBar) + 1.0) * quartersPerBar;
+  tick = std::max(tick, static_cast<int64_t>(std::llround(
+                            barEnd * kTicksPerQuarter)));
+  track.change(tick, sounding, NoteMask());
+  track.meta(tick, 0x2F, nullptr, 0); // End of track
+
+  uint64_t trackLength = out.tell() - trackStart;
+  uint8_t length[4] = {static_cast<uint8_t>(trackLength >> 24),
+                       static_cast<uint8_t>(trackLength >> 16),
+                       static_cast<uint8_t>(trackLength >> 8),
+                       static_cast<uint8_t>(trackLength)};
+  out.patch(lengthOffset, length, 4);
+  return out.closeOrRemove(path);
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
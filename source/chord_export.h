@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "chord_timeline.h"
+#include <cstddef>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// ChordSource - Chords in position order, one at a time
+//------------------------------------------------------------------------
+class ChordSource {
+public:
+  virtual ~ChordSource() {}
+  // False once there are no more chords
+  virtual bool next(TimelineChord &chord) = 0;
+};
+
+// The chords of a ChordTimeline
+class TimelineChordSource : public ChordSource {
+public:
+  explicit TimelineChordSource(const ChordTimeline &timeline)
+      : timeline(timeline) {}
+
+  bool next(TimelineChord &chord) override {
+    if (index >= timeline.size())
+      return false;
+    chord = timeline.getChord(index++);
+    return true;
+  }
+
+private:
+  const ChordTimeline &timeline;
+  size_t index = 0;
+};
+
+//------------------------------------------------------------------------
+// Export settings. Chords carry song positions but no meter or tempo, so
+// those come from here and hold for the whole export.
+//------------------------------------------------------------------------
+struct ExportOptions {
+  int beatsPerBar = 4;
+  int beatUnit = 4;     // 1, 2, 4, 8 or 16
+  double tempo = 120.0; // Quarter notes per minute, for MIDI files
+};
+
+// Up to 64 beats a bar of a power of two up to 16, and tempos that fit a
+// MIDI tempo event (about 3.6 bpm and up)
+
+bool isValidExportOptions(const ExportOptions &options);
+
+// The meter and tempo a timeline was recorded in. Where the writers can't
+// take the time signature or the tempo, that one stays at its default.
+ExportOptions getExportOptions(const TimelineMeter &meter);
+
+//------------------------------------------------------------------------
+// Chord export
+//
+// Both writers stream: chords are read from the source one at a time and
+// written through a BufferedFileWriter, with at most one bar of notes
+// held in between. Memory use doesn't depend on the length of the
+// capture. Each chord sounds until the next one; the last one until the
+// end of its bar. Notes a chord shares with the one before carry on from
+// it (tied in MusicXML, sustained in the MIDI file), and chords before
+// the song start are moved up to it in both. Both return false if the
+// file couldn't be written, and then remove what they wrote of it.
+//
+// MusicXML is a grand staff spelled as NotationView does it (note_spelling.h),
+// positions snapped to 16th notes. The MIDI file is format 0 at the exact
+// captured positions, 480 ticks a quarter note.
+//------------------------------------------------------------------------
+bool writeMusicXml(ChordSource &source, const ExportOptions &options,
+                   const char *path);
+bool writeMidiFile(ChordSource &source, const ExportOptions &options,
+                   const char *path);
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "note_state.h"
+#include "note_transport.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// ChordSnapshot - One chord as it was played
+//------------------------------------------------------------------------
+struct ChordSnapshot {
+  NoteMask notes;
+  KeySignature key = kCMajor;
+  double time = 0.0;     // Host time the chord started, in seconds
+  double duration = 0.0; // Until one of its notes was released, in seconds
+};
+
+//------------------------------------------------------------------------
+// ChordHistory - The last kCapacity chords, newest overwriting oldest
+//
+// Storage is a fixed array, so memory stays the same however long the
+// session runs and push() is a copy and an increment. UI thread only.
+//------------------------------------------------------------------------
+class ChordHistory {
+public:
+  static constexpr size_t kCapacity = 256;
+  static_assert((kCapacity & (kCapacity - 1)) == 0,
+                "ChordHistory capacity must be a power of two");
+
+  void push(const ChordSnapshot &snapshot) {
+    snapshots[numPushed & (kCapacity - 1)] = snapshot;
+    numPushed++;
+  }
+
+  void clear() { numPushed = 0; }
+
+  size_t size() const {
+    return numPushed < kCapacity ? static_cast<size_t>(numPushed) : kCapacity;
+  }
+
+  // age 0 is the most recent chord, size() - 1 the oldest still kept
+  const ChordSnapshot &getRecent(size_t age) const {
+    return snapshots[(numPushed - 1 - age) & (kCapacity - 1)];
+  }
+
+  // Changes with every push, including once the history is full
+  uint64_t getNumPushed() const { return numPushed; }
+
+private:
+  std::array<ChordSnapshot, kCapacity> snapshots;
+  uint64_t numPushed = 0;
+};
+
+//------------------------------------------------------------------------
+// ChordHistoryRecorder - Puts the processor's note transitions into a
+// ChordHistory
+//
+// A chord ends at the transition that releases one of its notes, however
+// soon after it started, and goes into the history with the processor's
+// times. A transition that only adds notes ends nothing: the fuller chord
+// just takes over from there. UI thread only.
+//------------------------------------------------------------------------
+class ChordHistoryRecorder {
+public:
+  explicit ChordHistoryRecorder(ChordHistory &history) : history(history) {}
+
+  void add(const NoteTransition &transition) {
+    if (transition.notes == notes)
+      return; // Sent again, nothing changed
+
+    NoteMask released = notes & (notes ^ transition.notes);
+    if (released.any())
+      history.push({notes, key, startTime,
+                    std::max(0.0, transition.time - startTime)});
+
+    notes = transition.notes;
+    key = transition.key;
+    startTime = transition.time;
+  }
+
+private:
+  ChordHistory &history;
+  NoteMask notes; // Sounding since startTime
+  KeySignature key = kCMajor;
+  double startTime = 0.0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
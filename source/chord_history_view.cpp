@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "chord_history_view.h"
+#include "chord_column.h"
+#include "vstgui/lib/ccolor.h"
+#include "vstgui/lib/crect.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Ursulean {
+
+namespace {
+// "80 ms" under a second, "2.5 s" from there
+void formatDuration(double seconds, char *text, size_t size) {
+  if (seconds < 1.0)
+    std::snprintf(text, size, "%d ms", static_cast<int>(seconds * 1000.0));
+  else
+    std::snprintf(text, size, "%.1f s", seconds);
+}
+} // namespace
+
+//------------------------------------------------------------------------
+ChordHistoryView::ChordHistoryView(const VSTGUI::CRect &size,
+                                   const ChordHistory &history)
+    : CView(size), history(history),
+      symbolFont(VSTGUI::makeOwned<VSTGUI::CFontDesc>("Arial", 12,
+                                                       VSTGUI::kBoldFace)),
+      durationFont(VSTGUI::makeOwned<VSTGUI::CFontDesc>("Arial", 10)) {}
+
+//------------------------------------------------------------------------
+void ChordHistoryView::update() {
+  if (history.getNumPushed() != numShown)
+    invalid();
+}
+
+//------------------------------------------------------------------------
+void ChordHistoryView::onMouseWheelEvent(VSTGUI::MouseWheelEvent &event) {
+  double delta = event.deltaX != 0.0 ? event.deltaX : event.deltaY;
+  if (delta == 0.0)
+    return;
+  scrollAge += delta;
+  clampScroll();
+  invalid();
+  event.consumed = true;
+}
+
+//------------------------------------------------------------------------
+size_t ChordHistoryView::getNumColumns() const {
+  return static_cast<size_t>(getViewSize().getWidth() / kColumnWidth) + 1;
+}
+
+//------------------------------------------------------------------------
+void ChordHistoryView::clampScroll() {
+  size_t numColumns = getNumColumns();
+  double maxAge = history.size() > numColumns
+                      ? static_cast<double>(history.size() - numColumns)
+                      : 0.0;
+  scrollAge = std::max(0.0, std::min(scrollAge, maxAge));
+}
+
+//------------------------------------------------------------------------
+void ChordHistoryView::draw(VSTGUI::CDrawContext *context) {
+  CView::draw(context);
+
+  // Scrolled back, the strip keeps showing the same chords as new ones
+  // come in
+  if (scrollAge > 0.0)
+    scrollAge += static_cast<double>(history.getNumPushed() - numShown);
+  numShown = history.getNumPushed();
+  clampScroll();
+
+  VSTGUI::CRect rect = getViewSize();
+  context->setDrawMode(VSTGUI::kAntiAliasing);
+  context->setLineStyle(VSTGUI::kLineSolid);
+  context->setFillColor(VSTGUI::CColor(250, 250, 250, 255));
+  context->drawRect(rect, VSTGUI::kDrawFilled);
+
+  // Only as many chords as there are columns on screen, from the one
+  // scrolled to at the right edge
+  size_t firstAge = static_cast<size_t>(scrollAge);
+  size_t endAge = std::min(history.size(), firstAge + getNumColumns());
+  auto columnAt = [&](size_t age) {
+    double right = rect.right - (age - firstAge) * kColumnWidth;
+    return VSTGUI::CRect(right - kColumnWidth, rect.top, right, rect.bottom);
+  };
+
+  // Ticks and dividers of all columns in one batch, symbols on top
+  batcher.clear();
+  for (size_t age = firstAge; age < endAge; age++) {
+    VSTGUI::CRect column = columnAt(age);
+    layoutChordColumn(batcher, history.getRecent(age).notes, column,
+                      column.top + kSymbolHeight + 2.0,
+                      column.bottom - kDurationHeight - 2.0);
+  }
+  batchRenderer.draw(context, batcher);
+
+  context->setFont(symbolFont);
+  context->setFontColor(VSTGUI::CColor(0, 0, 0, 255));
+  for (size_t age = firstAge; age < endAge; age++) {
+    const ChordSnapshot &snapshot = history.getRecent(age);
+    char symbol[32];
+    formatChordColumnSymbol(snapshot.notes, snapshot.key, symbol,
+                            sizeof(symbol));
+
+    VSTGUI::CRect symbolRect = columnAt(age);
+    symbolRect.bottom = symbolRect.top + kSymbolHeight;
+    context->drawString(symbol, symbolRect, VSTGUI::kCenterText);
+  }
+
+  context->setFont(durationFont);
+  context->setFontColor(VSTGUI::CColor(110, 110, 110, 255));
+  for (size_t age = firstAge; age < endAge; age++) {
+    char duration[16];
+    formatDuration(history.getRecent(age).duration, duration,
+                   sizeof(duration));
+
+    VSTGUI::CRect durationRect = columnAt(age);
+    durationRect.top = durationRect.bottom - kDurationHeight;
+    context->drawString(duration, durationRect, VSTGUI::kCenterText);
+  }
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
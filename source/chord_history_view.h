@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "batch_renderer.h"
+#include "chord_history.h"
+#include "draw_batcher.h"
+#include "vstgui/lib/cdrawcontext.h"
+#include "vstgui/lib/cfont.h"
+#include "vstgui/lib/cview.h"
+#include "vstgui/lib/events.h"
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// ChordHistoryView - Strip of the chords played last, newest on the right
+//
+// Each chord gets a column with its symbol, a tick per note across the
+// keyboard range and how long it sounded. Older chords move off to the
+// left as new ones come in; the mouse wheel scrolls back through the whole
+// history, and while scrolled back the strip stays on the same chords.
+// Only the columns that fit in the view are laid out, however long the
+// history is.
+//------------------------------------------------------------------------
+class ChordHistoryView : public VSTGUI::CView {
+public:
+  ChordHistoryView(const VSTGUI::CRect &size, const ChordHistory &history);
+  ~ChordHistoryView() override = default;
+
+  // CView overrides
+  void draw(VSTGUI::CDrawContext *context) override;
+  void onMouseWheelEvent(VSTGUI::MouseWheelEvent &event) override;
+
+  // Repaints if chords were added since the last call
+  void update();
+
+private:
+  static constexpr double kColumnWidth = 64.0;
+  static constexpr double kSymbolHeight = 18.0;
+  static constexpr double kDurationHeight = 14.0;
+
+  size_t getNumColumns() const;
+  void clampScroll();
+
+  const ChordHistory &history;
+  uint64_t numShown = 0;
+  double scrollAge = 0.0; // Age of the chord at the right edge, in columns
+
+  DrawBatcher batcher; // Note ticks and column dividers
+  BatchRenderer batchRenderer;
+  VSTGUI::SharedPointer<VSTGUI::CFontDesc> symbolFont;
+  VSTGUI::SharedPointer<VSTGUI::CFontDesc> durationFont;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,409 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "note_state.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// Chord qualities and extensions
+//------------------------------------------------------------------------
+enum ChordQuality : uint8_t {
+  kNoChord = 0,
+  kMajorTriad,
+  kMinorTriad,
+  kDiminishedTriad,
+  kAugmentedTriad,
+  kSus2Triad,
+  kSus4Triad,
+  kPowerChord,
+  kMajorSixth,
+  kMinorSixth,
+  kDominantSeventh,
+  kMajorSeventh,
+  kMinorSeventh,
+  kMinorMajorSeventh,
+  kHalfDiminishedSeventh,
+  kDiminishedSeventh,
+  kAugmentedSeventh,
+  kAugmentedMajorSeventh,
+  kDominantSeventhSus4,
+  kNumChordQualities
+};
+
+// Tensions on top of the chord, one bit each
+enum ChordExtension : uint8_t {
+  kExtFlatNine = 1 << 0,
+  kExtNine = 1 << 1,
+  kExtSharpNine = 1 << 2,
+  kExtEleven = 1 << 3,
+  kExtSharpEleven = 1 << 4,
+  kExtFlatThirteen = 1 << 5,
+  kExtThirteen = 1 << 6
+};
+
+// Symbol and chord tones of each quality, as semitones above the root
+// (0 where the quality has no such tone)
+struct ChordQualityInfo {
+  const char *symbol;
+  uint8_t third;
+  uint8_t fifth;
+  uint8_t seventh;
+};
+
+static constexpr ChordQualityInfo kChordQualityInfo[kNumChordQualities] = {
+    {"", 0, 0, 0},        // kNoChord
+    {"", 4, 7, 0},        // kMajorTriad
+    {"m", 3, 7, 0},       // kMinorTriad
+    {"dim", 3, 6, 0},     // kDiminishedTriad
+    {"aug", 4, 8, 0},     // kAugmentedTriad
+    {"sus2", 2, 7, 0},    // kSus2Triad
+    {"sus4", 5, 7, 0},    // kSus4Triad
+    {"5", 0, 7, 0},       // kPowerChord
+    {"6", 4, 7, 9},       // kMajorSixth
+    {"m6", 3, 7, 9},      // kMinorSixth
+    {"7", 4, 7, 10},      // kDominantSeventh
+    {"maj7", 4, 7, 11},   // kMajorSeventh
+    {"m7", 3, 7, 10},     // kMinorSeventh
+    {"m(maj7)", 3, 7, 11}, // kMinorMajorSeventh
+    {"m7b5", 3, 6, 10},   // kHalfDiminishedSeventh
+    {"dim7", 3, 6, 9},    // kDiminishedSeventh
+    {"7#5", 4, 8, 10},    // kAugmentedSeventh
+    {"maj7#5", 4, 8, 11}, // kAugmentedMajorSeventh
+    {"7sus4", 5, 7, 10},  // kDominantSeventhSus4
+};
+
+//------------------------------------------------------------------------
+// ChordEntry - Best reading of one pitch-class set
+//------------------------------------------------------------------------
+struct ChordEntry {
+  uint8_t root = 0;       // Pitch class 0-11 (C = 0)
+  uint8_t quality = kNoChord;
+  uint8_t extensions = 0; // ChordExtension bits
+  bool omitsFifth = false;
+  uint16_t bassRoots = 0; // Other roots that take over when in the bass
+};
+
+namespace ChordTableDetail {
+
+constexpr bool hasInterval(unsigned intervals, int semitones) {
+  return (intervals >> semitones) & 1;
+}
+
+// The set transposed so that bit 0 is root
+constexpr unsigned rotatePitchClasses(unsigned pitchClasses, int root) {
+  return ((pitchClasses >> root) | (pitchClasses << (12 - root))) & 0xFFF;
+}
+
+constexpr int countBits12(unsigned bits) {
+  int count = 0;
+  for (; bits; bits &= bits - 1)
+    count++;
+  return count;
+}
+
+// Reads the set as a chord on the given root. intervals holds the set
+// rotated so that bit 0 is the root. Returns a score, or -1 if some pitch
+// class can't be explained as a chord tone or tension.
+constexpr int readChord(unsigned intervals, int root, ChordEntry &entry) {
+  using namespace ChordTableDetail;
+
+  // Third (or its suspension)
+  int third = hasInterval(intervals, 4)   ? 4
+              : hasInterval(intervals, 3) ? 3
+              : hasInterval(intervals, 5) ? 5
+              : hasInterval(intervals, 2) ? 2
+                                          : 0;
+  // Fifth, altered only where the third makes the triad dim/aug
+  int fifth = hasInterval(intervals, 7)                  ? 7
+              : third == 3 && hasInterval(intervals, 6) ? 6
+              : third == 4 && hasInterval(intervals, 8) ? 8
+                                                        : 0;
+  // Seventh, or the sixth standing in for it
+  int seventh = hasInterval(intervals, 10) ? 10
+                : hasInterval(intervals, 11) ? 11
+                : hasInterval(intervals, 9) && fifth != 8 ? 9
+                                                          : 0;
+
+  uint8_t quality = kNoChord;
+  if (third == 4 && fifth != 8) {
+    quality = seventh == 10   ? kDominantSeventh
+              : seventh == 11 ? kMajorSeventh
+              : seventh == 9  ? kMajorSixth
+                              : kMajorTriad;
+  } else if (third == 4) {
+    quality = seventh == 10   ? kAugmentedSeventh
+              : seventh == 11 ? kAugmentedMajorSeventh
+                              : kAugmentedTriad;
+  } else if (third == 3 && fifth != 6) {
+    quality = seventh == 10   ? kMinorSeventh
+              : seventh == 11 ? kMinorMajorSeventh
+              : seventh == 9  ? kMinorSixth
+                              : kMinorTriad;
+  } else if (third == 3) {
+    quality = seventh == 10  ? kHalfDiminishedSeventh
+              : seventh == 9 ? kDiminishedSeventh
+                             : kDiminishedTriad;
+    if (seventh == 11)
+      seventh = 0; // Left over below, so the set is rejected
+  } else if (third == 5 && fifth == 7) {
+    quality = seventh == 10 ? kDominantSeventhSus4 : kSus4Triad;
+    if (seventh != 10)
+      seventh = 0;
+  } else if (third == 2 && fifth == 7) {
+    quality = kSus2Triad;
+    seventh = 0;
+  } else if (third == 0 && fifth == 7) {
+    quality = kPowerChord;
+    seventh = 0;
+  } else {
+    return -1;
+  }
+
+  unsigned remaining = intervals & ~((1u << 0) | (1u << third) |
+                                     (1u << fifth) | (1u << seventh));
+
+  // Whatever is left has to read as a tension
+  uint8_t extensions = 0;
+  if (hasInterval(remaining, 1))
+    extensions |= kExtFlatNine;
+  if (hasInterval(remaining, 2))
+    extensions |= kExtNine;
+  if (hasInterval(remaining, 3) && third == 4)
+    extensions |= kExtSharpNine;
+  if (hasInterval(remaining, 5))
+    extensions |= kExtEleven;
+  if (hasInterval(remaining, 6) && fifth != 6)
+    extensions |= kExtSharpEleven;
+  if (hasInterval(remaining, 8) && fifth != 8)
+    extensions |= kExtFlatThirteen;
+  if (hasInterval(remaining, 9))
+    extensions |= kExtThirteen;
+
+  remaining &= ~((1u << 1) | (1u << 2) | (third == 4 ? 1u << 3 : 0u) |
+                 (1u << 5) | (fifth != 6 ? 1u << 6 : 0u) |
+                 (fifth != 8 ? 1u << 8 : 0u) | (1u << 9));
+  if (remaining)
+    return -1;
+
+  // Prefer complete chords with few tensions. Sixth chords lose ties with
+  // their relative minor sevenths (C6 = Am7) unless the bass decides it,
+  // see identifyChord().
+  // A missing fifth is routine in seventh chords, less so in triads.
+  int score = 100 - 10 * countBits12(extensions);
+  if (fifth == 0 && quality != kPowerChord)
+    score -= seventh ? 5 : 15;
+  if (quality == kSus2Triad || quality == kSus4Triad)
+    score -= 5;
+  if (quality == kMajorSixth || quality == kMinorSixth)
+    score -= 2;
+
+  entry.root = static_cast<uint8_t>(root);
+  entry.quality = quality;
+  entry.extensions = extensions;
+  entry.omitsFifth = fifth == 0 && quality != kPowerChord;
+  return score;
+}
+
+// Readings on the bass that come within this of the best one are preferred,
+// so C-E-G-A over C is C6 rather than Am7/C
+static constexpr int kRootPositionBonus = 5;
+
+constexpr ChordEntry classify(unsigned pitchClasses) {
+  ChordEntry best;
+  // Two pitch classes only make a chord as a power chord
+  int numPitchClasses = countBits12(pitchClasses);
+  if (numPitchClasses < 2)
+    return best;
+
+  int scores[12] = {};
+  int bestScore = -1;
+  for (int root = 0; root < 12; root++) {
+    scores[root] = -1;
+    if (!hasInterval(pitchClasses, root))
+      continue;
+    ChordEntry candidate;
+    int score =
+        readChord(rotatePitchClasses(pitchClasses, root), root, candidate);
+    if (numPitchClasses == 2 && candidate.quality != kPowerChord)
+      continue;
+    scores[root] = score;
+    if (score > bestScore) {
+      bestScore = score;
+      best = candidate;
+    }
+  }
+
+  for (int root = 0; root < 12; root++) {
+    if (root != best.root && scores[root] >= 0 &&
+        scores[root] + kRootPositionBonus >= bestScore)
+      best.bassRoots |= static_cast<uint16_t>(1u << root);
+  }
+  return best;
+}
+
+// The table is built in slices, each its own constant expression, to stay
+// well inside the compilers' constexpr evaluation step limits
+static constexpr size_t kSliceSize = 64;
+static constexpr size_t kNumSlices = 4096 / kSliceSize;
+
+constexpr std::array<ChordEntry, kSliceSize> buildSlice(size_t slice) {
+  std::array<ChordEntry, kSliceSize> entries{};
+  for (size_t i = 0; i < kSliceSize; i++)
+    entries[i] = classify(static_cast<unsigned>(slice * kSliceSize + i));
+  return entries;
+}
+
+template <size_t Slice> struct TableSlice {
+  static constexpr std::array<ChordEntry, kSliceSize> entries =
+      buildSlice(Slice);
+};
+
+template <size_t... Slices>
+constexpr std::array<const ChordEntry *, sizeof...(Slices)>
+slicePointers(std::index_sequence<Slices...>) {
+  return {{TableSlice<Slices>::entries.data()...}};
+}
+
+static constexpr std::array<const ChordEntry *, kNumSlices> kSlices =
+    slicePointers(std::make_index_sequence<kNumSlices>());
+
+} // namespace ChordTableDetail
+
+//------------------------------------------------------------------------
+// Chord lookup
+//
+// Every 12-bit pitch-class set is classified at compile time, so naming
+// the sounding chord is a fold of the note mask plus one table read.
+//------------------------------------------------------------------------
+
+// Bit n set = pitch class n sounding. ORs the mask together one octave at
+// a time, so the cost doesn't depend on how many notes are down.
+inline uint16_t pitchClassSet(const NoteMask &notes) {
+  const uint64_t low = notes.words[0];
+  const uint64_t high = notes.words[1];
+  // Notes 0-59 and 60-123, each folded down to the lowest octave
+  uint64_t lower = low & ((uint64_t(1) << 60) - 1);
+  uint64_t upper = (low >> 60) | (high << 4);
+  uint64_t folded = lower | upper;
+  folded |= folded >> 36;
+  folded |= folded >> 24;
+  folded |= folded >> 12;
+  // Notes 120-127 didn't fit in upper
+  return static_cast<uint16_t>((folded | (high >> 56)) & 0xFFF);
+}
+
+inline const ChordEntry &lookupChord(uint16_t pitchClasses) {
+  pitchClasses &= 0xFFF;
+  return ChordTableDetail::kSlices[pitchClasses / ChordTableDetail::kSliceSize]
+                                  [pitchClasses % ChordTableDetail::kSliceSize];
+}
+
+// Chord reading of the sounding notes, including what is in the bass
+struct ChordName {
+  ChordEntry chord;
+  uint8_t bass = 0;      // Pitch class of the lowest sounding note
+  uint8_t inversion = 0; // 0 root position, 1-3 third/fifth/seventh in the
+                         // bass, kOtherBass for anything else
+  bool isValid() const { return chord.quality != kNoChord; }
+
+  static constexpr uint8_t kOtherBass = 4;
+};
+
+inline ChordName identifyChord(const NoteMask &notes) {
+  using namespace ChordTableDetail;
+
+  ChordName name;
+  if (!notes.any())
+    return name;
+
+  uint16_t pitchClasses = pitchClassSet(notes);
+  int lowest = notes.words[0] ? lowestBit64(notes.words[0])
+                              : 64 + lowestBit64(notes.words[1]);
+  name.bass = static_cast<uint8_t>(lowest % 12);
+  name.chord = lookupChord(pitchClasses);
+  if (!name.isValid())
+    return name;
+
+  // The table can't know the bass, only which roots would take over if
+  // they were in it. That is rare enough to read the chord again here.
+  if ((name.chord.bassRoots >> name.bass) & 1) {
+    ChordEntry bassReading;
+    readChord(rotatePitchClasses(pitchClasses, name.bass), name.bass,
+              bassReading);
+    name.chord = bassReading;
+  }
+
+  const ChordQualityInfo &info = kChordQualityInfo[name.chord.quality];
+  int bassInterval = (name.bass - name.chord.root + 12) % 12;
+  name.inversion = bassInterval == 0                ? 0
+                   : bassInterval == info.third     ? 1
+                   : bassInterval == info.fifth     ? 2
+                   : bassInterval == info.seventh   ? 3
+                                                    : ChordName::kOtherBass;
+  return name;
+}
+
+// Writes e.g. "Am7/C", "Bbmaj7(#11)" or "Dadd9" into buffer (always
+// terminated). Returns the symbol length; an empty symbol when there is no
+// chord.
+inline size_t formatChordSymbol(const ChordName &name, bool useFlats,
+                                char *buffer, size_t bufferSize) {
+  static const char *const kSharpNames[12] = {
+      "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+  static const char *const kFlatNames[12] = {
+      "C", "Db", "D", "Eb", "E", "F", "Gb", "G", "Ab", "A", "Bb", "B"};
+
+  size_t length = 0;
+  auto append = [&](const char *text) {
+    for (; *text && length + 1 < bufferSize; text++)
+      buffer[length++] = *text;
+  };
+  if (bufferSize == 0)
+    return 0;
+
+  if (name.isValid()) {
+    const char *const *names = useFlats ? kFlatNames : kSharpNames;
+    const ChordEntry &chord = name.chord;
+    append(names[chord.root]);
+    append(kChordQualityInfo[chord.quality].symbol);
+
+    // A lone 9th or 11th over a triad reads as "add"
+    bool isTriad = kChordQualityInfo[chord.quality].seventh == 0;
+    if (isTriad &&
+        (chord.extensions == kExtNine || chord.extensions == kExtEleven)) {
+      append(chord.extensions == kExtNine ? "add9" : "add11");
+    } else if (chord.extensions) {
+      static const char *const kExtensionNames[7] = {"b9",  "9",   "#9", "11",
+                                                     "#11", "b13", "13"};
+      const char *separator = "(";
+      for (int i = 0; i < 7; i++) {
+        if (chord.extensions & (1 << i)) {
+          append(separator);
+          append(kExtensionNames[i]);
+          separator = ",";
+        }
+      }
+      append(")");
+    }
+    if (chord.omitsFifth && isTriad)
+      append("(no5)");
+    if (name.inversion != 0) {
+      append("/");
+      append(names[name.bass]);
+    }
+  }
+
+  buffer[length] = '\0';
+  return length;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
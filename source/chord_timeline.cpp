@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "chord_timeline.h"
+
+#include <algorithm>
+
+namespace Ursulean {
+
+namespace {
+// First chord after position
+std::vector<TimelineChord>::const_iterator
+chordAfter(const std::vector<TimelineChord> &chords, double position) {
+  return std::upper_bound(chords.begin(), chords.end(), position,
+                          [](double p, const TimelineChord &chord) {
+                            return p < chord.position;
+                          });
+}
+} // namespace
+
+//------------------------------------------------------------------------
+ChordTimeline::ChordTimeline() { chords.reserve(kReservedChords); }
+
+//------------------------------------------------------------------------
+void ChordTimeline::record(double position, int32_t bar,
+                           const NoteMask &notes, KeySignature key) {
+  version++;
+  TimelineChord chord;
+  chord.notes = notes;
+  chord.position = position;
+  chord.bar = bar;
+  chord.key = key;
+
+  if (lastRecorded != kNone && chords[lastRecorded].position == position) {
+    chords[lastRecorded] = chord;
+    return;
+  }
+
+  // Everything an earlier pass left between the previous change of this
+  // pass and this one goes. After a jump, only a chord at this very
+  // position is replaced.
+  size_t end = chordAfter(chords, position) - chords.begin();
+  size_t first = end;
+  if (lastRecorded != kNone && chords[lastRecorded].position < position)
+    first = lastRecorded + 1;
+  else if (end > 0 && chords[end - 1].position == position)
+    first = end - 1;
+
+  if (first < end) {
+    chords[first] = chord;
+    chords.erase(chords.begin() + first + 1, chords.begin() + end);
+  } else {
+    chords.insert(chords.begin() + first, chord);
+  }
+  lastRecorded = first;
+}
+
+//------------------------------------------------------------------------
+void ChordTimeline::clear() {
+  version++;
+  chords.clear();
+  lastRecorded = kNone;
+  meter = TimelineMeter();
+}
+
+//------------------------------------------------------------------------
+size_t ChordTimeline::seek(double position) const {
+  size_t after = chordAfter(chords, position) - chords.begin();
+  return after > 0 ? after - 1 : kNone;
+}
+
+//------------------------------------------------------------------------
+// ChordTimelineRecorder
+//------------------------------------------------------------------------
+void ChordTimelineRecorder::add(const NoteTransition &transition) {
+  if (!transition.isPlaying)
+    return;
+
+  if (!hasJumps || transition.jumps != jumps)
+    timeline.breakRecording();
+  hasJumps = true;
+  jumps = transition.jumps;
+
+  timeline.record(transition.position, transition.bar, transition.notes,
+                  transition.key);
+  timeline.setMeter(
+      {transition.beatsPerBar, transition.beatUnit, transition.tempo});
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
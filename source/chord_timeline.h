@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "note_state.h"
+#include "note_transport.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// TimelineChord - The notes sounding from one song position to the next
+//------------------------------------------------------------------------
+struct TimelineChord {
+  NoteMask notes;         // Empty for a rest
+  double position = 0.0;  // Quarter notes from the project start
+  int32_t bar = 0;        // From 0
+  KeySignature key = kCMajor;
+};
+
+// 32 bytes a chord: an hour of two changes a second is about 230 KB
+static_assert(sizeof(TimelineChord) <= 32, "TimelineChord grew");
+
+// The host's time signature and tempo
+struct TimelineMeter {
+  int32_t beatsPerBar = 4;
+  int32_t beatUnit = 4;
+  double tempo = 120.0; // Quarter notes per minute
+};
+
+//------------------------------------------------------------------------
+// ChordTimeline - Chord changes indexed by song position
+//
+// Chords are kept sorted by position in one flat array, so finding the
+// chord at any position is a binary search, however long the session.
+// While the transport plays, record() mostly appends. Playing over a
+// stretch again (a loop, or after a locate) replaces what an earlier pass
+// recorded between this pass's changes, so the timeline always holds one
+// chord per position: the last one played there. Call breakRecording()
+// on a jump so the next change doesn't overwrite the skipped stretch.
+// The timeline keeps one meter, the host's at the change recorded last.
+// UI thread only.
+//------------------------------------------------------------------------
+class ChordTimeline {
+public:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  ChordTimeline();
+
+  // A change at position. A change at the position of the previous one
+  // (the rest of its note mask arriving) updates it instead.
+  void record(double position, int32_t bar, const NoteMask &notes,
+              KeySignature key);
+  void breakRecording() { lastRecorded = kNone; }
+  void setMeter(const TimelineMeter &newMeter) { meter = newMeter; }
+  // Also sets the meter back to 4/4 at 120 bpm
+  void clear();
+
+  // The chord sounding at position, kNone before the first one
+  size_t seek(double position) const;
+
+  size_t size() const { return chords.size(); }
+  const TimelineChord &getChord(size_t index) const { return chords[index]; }
+  const TimelineMeter &getMeter() const { return meter; }
+
+  // Index of the chord recorded last, kNone after breakRecording()
+  size_t getLastRecorded() const { return lastRecorded; }
+  // Changes with every record() and clear()
+  uint64_t getVersion() const { return version; }
+
+private:
+  static constexpr size_t kReservedChords = 4096;
+
+  std::vector<TimelineChord> chords; // Sorted by position
+  size_t lastRecorded = kNone;
+  TimelineMeter meter;
+  uint64_t version = 0;
+};
+
+//------------------------------------------------------------------------
+// ChordTimelineRecorder - Puts the processor's note transitions on a
+// timeline
+//
+// Transitions made while the transport played are recorded at their own
+// song position, and with them the host's meter. A new jump count breaks
+// the recording before the transition that carries it. UI thread only.
+//------------------------------------------------------------------------
+class ChordTimelineRecorder {
+public:
+  explicit ChordTimelineRecorder(ChordTimeline &timeline)
+      : timeline(timeline) {}
+
+  void add(const NoteTransition &transition);
+
+private:
+  ChordTimeline &timeline;
+  bool hasJumps = false;
+  uint32_t jumps = 0; // Of the last recorded transition
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "chord_timeline_view.h"
+#include "chord_column.h"
+#include "vstgui/lib/ccolor.h"
+#include "vstgui/lib/crect.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+ChordTimelineView::ChordTimelineView(const VSTGUI::CRect &size,
+                                     const ChordTimeline &timeline)
+    : CView(size), timeline(timeline),
+      symbolFont(VSTGUI::makeOwned<VSTGUI::CFontDesc>("Arial", 12,
+                                                       VSTGUI::kBoldFace)),
+      barFont(VSTGUI::makeOwned<VSTGUI::CFontDesc>("Arial", 10)) {}
+
+//------------------------------------------------------------------------
+size_t ChordTimelineView::getNumColumns() const {
+  size_t numColumns =
+      static_cast<size_t>(getViewSize().getWidth() / kColumnWidth);
+  return std::max<size_t>(numColumns, 1);
+}
+
+//------------------------------------------------------------------------
+void ChordTimelineView::locate(double position) {
+  currentIndex = timeline.seek(position);
+  firstIndex = currentIndex == ChordTimeline::kNone ? 0 : currentIndex;
+  invalid();
+}
+
+//------------------------------------------------------------------------
+void ChordTimelineView::update() {
+  if (timeline.getVersion() == shownVersion)
+    return;
+  shownVersion = timeline.getVersion();
+
+  size_t last = timeline.getLastRecorded();
+  if (last != ChordTimeline::kNone) {
+    currentIndex = last;
+    size_t numColumns = getNumColumns();
+    if (last < firstIndex)
+      firstIndex = last;
+    else if (last >= firstIndex + numColumns)
+      firstIndex = last + 1 - numColumns;
+  }
+  invalid();
+}
+
+//------------------------------------------------------------------------
+void ChordTimelineView::draw(VSTGUI::CDrawContext *context) {
+  CView::draw(context);
+
+  VSTGUI::CRect rect = getViewSize();
+  context->setDrawMode(VSTGUI::kAntiAliasing);
+  context->setLineStyle(VSTGUI::kLineSolid);
+  context->setFillColor(VSTGUI::CColor(250, 250, 250, 255));
+  context->drawRect(rect, VSTGUI::kDrawFilled);
+
+  // Columns from firstIndex on, the last one cut off by the edge
+  size_t end = std::min(timeline.size(), firstIndex + getNumColumns() + 1);
+  auto columnAt = [&](size_t index) {
+    double left = rect.left + (index - firstIndex) * kColumnWidth;
+    return VSTGUI::CRect(left, rect.top, left + kColumnWidth, rect.bottom);
+  };
+
+  if (currentIndex >= firstIndex && currentIndex < end) {
+    context->setFillColor(VSTGUI::CColor(225, 235, 250, 255));
+    context->drawRect(columnAt(currentIndex), VSTGUI::kDrawFilled);
+  }
+
+  // Ticks and dividers of all columns in one batch, text on top
+  batcher.clear();
+  for (size_t i = firstIndex; i < end; i++) {
+    VSTGUI::CRect column = columnAt(i);
+    layoutChordColumn(batcher, timeline.getChord(i).notes, column,
+                      column.top + kSymbolHeight + 2.0,
+                      column.bottom - kBarHeight - 2.0);
+  }
+  batchRenderer.draw(context, batcher);
+
+  context->setFont(symbolFont);
+  context->setFontColor(VSTGUI::CColor(0, 0, 0, 255));
+  for (size_t i = firstIndex; i < end; i++) {
+    const TimelineChord &chord = timeline.getChord(i);
+    char symbol[32];
+    formatChordColumnSymbol(chord.notes, chord.key, symbol, sizeof(symbol));
+
+    VSTGUI::CRect symbolRect = columnAt(i);
+    symbolRect.bottom = symbolRect.top + kSymbolHeight;
+    context->drawString(symbol, symbolRect, VSTGUI::kCenterText);
+  }
+
+  // Bar numbers (from 1) where a new bar starts
+  context->setFont(barFont);
+  context->setFontColor(VSTGUI::CColor(120, 120, 120, 255));
+  for (size_t i = firstIndex; i < end; i++) {
+    int32_t bar = timeline.getChord(i).bar;
+    if (i > firstIndex && timeline.getChord(i - 1).bar == bar)
+      continue;
+
+    char label[16];
+    std::snprintf(label, sizeof(label), "%d", static_cast<int>(bar) + 1);
+    VSTGUI::CRect barRect = columnAt(i);
+    barRect.left += 3.0;
+    barRect.top = barRect.bottom - kBarHeight;
+    context->drawString(label, barRect, VSTGUI::kLeftText);
+  }
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
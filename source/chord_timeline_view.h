@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "batch_renderer.h"
+#include "chord_timeline.h"
+#include "draw_batcher.h"
+#include "vstgui/lib/cdrawcontext.h"
+#include "vstgui/lib/cfont.h"
+#include "vstgui/lib/cview.h"
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// ChordTimelineView - The chords of the song, left to right from the
+// transport position
+//
+// Follows the chord recorded last while the transport plays. When the
+// host locates or loops, the view jumps to the chord at the new position
+// with one ChordTimeline::seek(). Bar numbers mark where bars change.
+//------------------------------------------------------------------------
+class ChordTimelineView : public VSTGUI::CView {
+public:
+  ChordTimelineView(const VSTGUI::CRect &size, const ChordTimeline &timeline);
+  ~ChordTimelineView() override = default;
+
+  // CView overrides
+  void draw(VSTGUI::CDrawContext *context) override;
+
+  // Shows the chords from position on
+  void locate(double position);
+
+  // Scrolls to the chord recorded last and repaints, if the timeline
+  // changed since the last call
+  void update();
+
+private:
+  static constexpr double kColumnWidth = 64.0;
+  static constexpr double kSymbolHeight = 18.0;
+  static constexpr double kBarHeight = 14.0;
+
+  size_t getNumColumns() const;
+
+  const ChordTimeline &timeline;
+  uint64_t shownVersion = 0;
+  size_t firstIndex = 0;                      // Leftmost column
+  size_t currentIndex = ChordTimeline::kNone; // Highlighted column
+
+  DrawBatcher batcher; // Note ticks and column dividers
+  BatchRenderer batchRenderer;
+  VSTGUI::SharedPointer<VSTGUI::CFontDesc> symbolFont;
+  VSTGUI::SharedPointer<VSTGUI::CFontDesc> barFont;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "note_transport.h"
 #include "pluginterfaces/base/funknown.h"
 #include "pluginterfaces/vst/vsttypes.h"
 
@@ -20,5 +21,26 @@ static const Steinberg::FUID kNotationChordHelperControllerUID(0x8C9D4372,
 
 #define NotationChordHelperVST3Category "Instrument"
 
+// Parameter IDs for communication. All 128 notes travel as a packed mask
+// spread over kNumNoteMaskWords read-only parameters (see note_transport.h).
+enum {
+  kNoteMaskFirstParam = 0, // Notes 0-15, next parameter notes 16-31, ...
+  kNoteMaskLastParam = kNoteMaskFirstParam + kNumNoteMaskWords - 1,
+  kKeySignatureParam = 10,
+  kBypassParam = 11,
+  kAutoKeyParam = 12, // Let the processor set the key from what is played
+  kLocateParam = 13,  // Where the transport jumped to
+  kTransitionFirstParam = 14, // One parameter per part of a note transition
+  kTransitionLastParam = kTransitionFirstParam + kNumTransitionParts - 1,
+  kNumParams = kTransitionLastParam + 1
+};
+
+// Build with NOTATION_HELPER_EVENT_ONLY=1 (CMake option of the same name) to
+// drop the always-silent audio output bus, for hosts that accept instruments
+// without audio outputs
+#ifndef NOTATION_HELPER_EVENT_ONLY
+#define NOTATION_HELPER_EVENT_ONLY 0
+#endif
+
 //------------------------------------------------------------------------
 } // namespace Ursulean
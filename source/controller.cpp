@@ -23,40 +23,16 @@ NotationChordHelperController::initialize(FUnknown *context) {
     return result;
   }
 
-  // Initialize note parameter tracking
-  currentNoteParams.resize(10, -1); // -1 means no note in this slot
-
-  // Register parameters for communication (10 note parameters)
-  parameters.addParameter(STR16("Note 1"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote1Param);
-  parameters.addParameter(STR16("Note 2"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote2Param);
-  parameters.addParameter(STR16("Note 3"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote3Param);
-  parameters.addParameter(STR16("Note 4"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote4Param);
-  parameters.addParameter(STR16("Note 5"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote5Param);
-  parameters.addParameter(STR16("Note 6"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote6Param);
-  parameters.addParameter(STR16("Note 7"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote7Param);
-  parameters.addParameter(STR16("Note 8"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote8Param);
-  parameters.addParameter(STR16("Note 9"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote9Param);
-  parameters.addParameter(STR16("Note 10"), nullptr, 0, 0,
-                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
-                          kNote10Param);
+  // Register the packed note mask parameters (16 notes each)
+  static const Steinberg::Vst::TChar *noteMaskTitles[kNumNoteMaskWords] = {
+      STR16("Notes 0-15"),   STR16("Notes 16-31"), STR16("Notes 32-47"),
+      STR16("Notes 48-63"),  STR16("Notes 64-79"), STR16("Notes 80-95"),
+      STR16("Notes 96-111"), STR16("Notes 112-127")};
+  for (int i = 0; i < kNumNoteMaskWords; i++) {
+    parameters.addParameter(noteMaskTitles[i], nullptr, 0, 0,
+                            Steinberg::Vst::ParameterInfo::kIsReadOnly,
+                            kNoteMaskFirstParam + i);
+  }
 
   // Add key signature parameter
   parameters.addParameter(STR16("Key Signature"), STR16("Key"), 0, 0,
@@ -64,6 +40,35 @@ NotationChordHelperController::initialize(FUnknown *context) {
                               Steinberg::Vst::ParameterInfo::kIsList,
                           kKeySignatureParam);
 
+  // Add bypass parameter
+  parameters.addParameter(STR16("Bypass"), nullptr, 1, 0,
+                          Steinberg::Vst::ParameterInfo::kCanAutomate |
+                              Steinberg::Vst::ParameterInfo::kIsBypass,
+                          kBypassParam);
+
+  // Add auto key parameter. While on, the processor sends the key it
+  // detects back through kKeySignatureParam.
+  parameters.addParameter(STR16("Auto Key"), nullptr, 1, 0,
+                          Steinberg::Vst::ParameterInfo::kCanAutomate,
+                          kAutoKeyParam);
+
+  // Transport jumps and note transitions for the chord timeline (see
+  // note_transport.h)
+  parameters.addParameter(STR16("Locate"), nullptr, 0, 0,
+                          Steinberg::Vst::ParameterInfo::kIsReadOnly,
+                          kLocateParam);
+  static const Steinberg::Vst::TChar
+      *transitionTitles[kNumTransitionParts] = {
+          STR16("Transition Notes Low"), STR16("Transition Notes Mid"),
+          STR16("Transition Notes High"), STR16("Transition Time"),
+          STR16("Transition Position"), STR16("Transition Tag"),
+          STR16("Transition Meter")};
+  for (int i = 0; i < kNumTransitionParts; i++) {
+    parameters.addParameter(transitionTitles[i], nullptr, 0, 0,
+                            Steinberg::Vst::ParameterInfo::kIsReadOnly,
+                            kTransitionFirstParam + i);
+  }
+
   return result;
 }
 
@@ -85,23 +90,40 @@ NotationChordHelperController::setComponentState(IBStream *state) {
   if (!state)
     return kResultFalse;
 
-  // Read saved processor state for preset loading
+  // Read saved processor state for preset loading (same layout as
+  // NotationChordHelperProcessor::getState)
   IBStreamer streamer(state, kLittleEndian);
 
+  int32 keySig = 0;
+  if (!streamer.readInt32(keySig))
+    return kResultOk;
+  if (keySig >= 0 && keySig < kNumKeySigs) {
+    setParamNormalized(kKeySignatureParam,
+                       static_cast<double>(keySig) / (kNumKeySigs - 1));
+  }
+
   // Read number of saved notes (for preset state)
   int32 numNotes = 0;
-  if (streamer.readInt32(numNotes) == kResultFalse)
+  if (!streamer.readInt32(numNotes))
     return kResultOk;
 
-  // Read the saved notes and restore display state
-  std::vector<int> savedNotes;
+  // Skip past the saved notes
   for (int32 i = 0; i < numNotes; i++) {
     int32 note = 0;
-    if (streamer.readInt32(note) == kResultOk) {
-      if (note >= 0 && note <= 127) {
-        savedNotes.push_back(note);
-      }
-    }
+    if (!streamer.readInt32(note))
+      return kResultOk;
+  }
+
+  // Bypass was appended later; older states simply end here
+  int32 bypass = 0;
+  if (streamer.readInt32(bypass)) {
+    setParamNormalized(kBypassParam, bypass ? 1.0 : 0.0);
+  }
+
+  // As is auto key, after bypass
+  int32 autoKey = 0;
+  if (streamer.readInt32(autoKey)) {
+    setParamNormalized(kAutoKeyParam, autoKey ? 1.0 : 0.0);
   }
 
   // Only update display if this is a preset load, not real-time MIDI
@@ -141,44 +163,27 @@ NotationChordHelperController::createView(FIDString name) {
   return nullptr;
 }
 
-//------------------------------------------------------------------------
-void NotationChordHelperController::setActiveNotes(
-    const std::vector<int> &notes) {
-  if (currentEditor) {
-    currentEditor->setActiveNotes(notes);
-  }
-}
-
 //------------------------------------------------------------------------
 tresult PLUGIN_API NotationChordHelperController::setParamNormalized(
     Steinberg::Vst::ParamID tag, Steinberg::Vst::ParamValue value) {
   // Handle parameter changes from processor
   tresult result = EditControllerEx1::setParamNormalized(tag, value);
 
-  if (tag >= 0 && tag < 10) {
-    // Update the note in this parameter slot
-    if (value > 0.0) {
-      // Decode the MIDI note from the normalized value (0.0-1.0 maps to 0-127)
-      int midiNote =
-          static_cast<int>(value * 127.0 + 0.5); // Add 0.5 for rounding
-      if (midiNote >= 0 && midiNote <= 127) {
-        currentNoteParams[tag] = midiNote;
-      }
-    } else {
-      // Value is 0.0, clear this note slot
-      currentNoteParams[tag] = -1;
-    }
+  if (tag >= kNoteMaskFirstParam && tag <= kNoteMaskLastParam) {
+    // Each parameter carries 16 notes of the packed mask
+    NoteMask notes = currentNotes;
+    setNoteMaskWord(notes, tag - kNoteMaskFirstParam,
+                    normalizedToNoteMaskWord(value));
+
+    if (notes != currentNotes) {
+      currentNotes = notes;
 
-    // Collect all active notes from all parameter slots
-    std::vector<int> activeNotes;
-    for (int noteParam : currentNoteParams) {
-      if (noteParam >= 0) { // -1 means empty slot
-        activeNotes.push_back(noteParam);
+      // One chord change arrives as several words; the editor only
+      // redraws once per display frame
+      if (currentEditor) {
+        currentEditor->setActiveNotes(currentNotes);
       }
     }
-
-    // Update the notation display with all active notes
-    setActiveNotes(activeNotes);
   } else if (tag == kKeySignatureParam) {
     // Handle key signature parameter change
     int keyIndex = static_cast<int>(value * (kNumKeySigs - 1) + 0.5);
@@ -189,6 +194,16 @@ tresult PLUGIN_API NotationChordHelperController::setParamNormalized(
         currentEditor->setKeySignature(currentKeySignature);
       }
     }
+  } else if (tag >= kTransitionFirstParam && tag <= kTransitionLastParam) {
+    if (transitionAssembler.add(tag - kTransitionFirstParam, value)) {
+      historyRecorder.add(transitionAssembler.getTransition());
+      timelineRecorder.add(transitionAssembler.getTransition());
+    }
+  } else if (tag == kLocateParam) {
+    // Only moves the view; the recorder sees jumps in the transitions
+    if (currentEditor) {
+      currentEditor->locateTimeline(normalizedToSongPosition(value));
+    }
   }
 
   return result;
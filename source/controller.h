@@ -4,28 +4,15 @@
 
 #pragma once
 
+#include "chord_history.h"
+#include "chord_timeline.h"
+#include "cids.h"
 #include "key_signature.h"
 #include "notation_editor.h"
 #include "public.sdk/source/vst/vsteditcontroller.h"
 
 namespace Ursulean {
 
-// Parameter IDs for communication (support up to 10 simultaneous notes)
-enum {
-  kNote1Param = 0,
-  kNote2Param = 1,
-  kNote3Param = 2,
-  kNote4Param = 3,
-  kNote5Param = 4,
-  kNote6Param = 5,
-  kNote7Param = 6,
-  kNote8Param = 7,
-  kNote9Param = 8,
-  kNote10Param = 9,
-  kKeySignatureParam = 10,
-  kNumParams = 11
-};
-
 //------------------------------------------------------------------------
 //  NotationChordHelperController
 //------------------------------------------------------------------------
@@ -61,8 +48,10 @@ public:
                      Steinberg::Vst::ParamValue value) SMTG_OVERRIDE;
 
   // Custom methods for notation display
-  void setActiveNotes(const std::vector<int> &notes);
+  const NoteMask &getCurrentNotes() const { return currentNotes; }
   KeySignature getCurrentKeySignature() const { return currentKeySignature; }
+  const ChordHistory &getChordHistory() const { return chordHistory; }
+  const ChordTimeline &getChordTimeline() const { return chordTimeline; }
 
   //---Interface---------
   DEFINE_INTERFACES
@@ -74,10 +63,17 @@ public:
   //------------------------------------------------------------------------
 protected:
   NotationEditor *currentEditor = nullptr;
-  std::vector<int> lastActiveNotes;
-  std::vector<int>
-      currentNoteParams; // Track which MIDI note is in each parameter slot
+  NoteMask currentNotes; // Notes decoded from the note mask parameters
   KeySignature currentKeySignature = kCMajor;
+
+  // Note transitions as the processor sent them, whatever order the host
+  // delivers their parts in. They end chords in the history at the
+  // processor's times and put them on the timeline at their song positions.
+  NoteTransitionAssembler transitionAssembler;
+  ChordHistory chordHistory;
+  ChordHistoryRecorder historyRecorder{chordHistory};
+  ChordTimeline chordTimeline;
+  ChordTimelineRecorder timelineRecorder{chordTimeline};
 };
 
 //------------------------------------------------------------------------
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "draw_batcher.h"
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+bool DrawBatcher::add(const DisplayItem &item, double originX,
+                      double originY) {
+  double x = originX + item.left;
+  double y = originY + item.top;
+  double s = item.size;
+
+  switch (item.type) {
+  case DisplayItemType::kLine:
+  case DisplayItemType::kLedgerLine:
+    addLine(batchFor(DrawBatchKind::kLines, item.color, item.lineWidth), x, y,
+            originX + item.right, originY + item.bottom);
+    return true;
+  case DisplayItemType::kNoteHead:
+    // Note head as an ellipse filling the bounds
+    batchFor(DrawBatchKind::kFilledEllipses, item.color, 0.0)
+        .ellipses.push_back(
+            {x, y, originX + item.right, originY + item.bottom});
+    return true;
+  case DisplayItemType::kSharp: {
+    DrawBatch &lines =
+        batchFor(DrawBatchKind::kLines, item.color, item.lineWidth);
+    // Vertical lines
+    addLine(lines, x + s * 0.25, y - s * 0.75, x + s * 0.25, y + s * 0.75);
+    addLine(lines, x + s * 0.75, y - s * 0.75, x + s * 0.75, y + s * 0.75);
+    // Horizontal lines
+    addLine(lines, x, y - s * 0.25, x + s, y - s * 0.5);
+    addLine(lines, x, y + s * 0.25, x + s, y);
+    return true;
+  }
+  case DisplayItemType::kFlat:
+    addLine(batchFor(DrawBatchKind::kLines, item.color, item.lineWidth),
+            x + s * 0.25, y - s, x + s * 0.25, y + s * 0.5);
+    batchFor(DrawBatchKind::kStrokedEllipses, item.color, item.lineWidth)
+        .ellipses.push_back({x + s * 0.25, y - s * 0.25, x + s, y + s * 0.5});
+    return true;
+  case DisplayItemType::kNatural: {
+    DrawBatch &lines =
+        batchFor(DrawBatchKind::kLines, item.color, item.lineWidth);
+    // Two vertical lines
+    addLine(lines, x + s * 0.125, y - s, x + s * 0.125, y + s * 0.5);
+    addLine(lines, x + s * 0.625, y - s * 0.5, x + s * 0.625, y + s);
+    // Two horizontal connecting lines (slightly slanted)
+    addLine(lines, x + s * 0.125, y - s * 0.25, x + s * 0.625, y - s * 0.5);
+    addLine(lines, x + s * 0.125, y + s * 0.25, x + s * 0.625, y);
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------
+void DrawBatcher::clear() {
+  for (size_t i = 0; i < numBatches; i++) {
+    batches[i].segments.clear();
+    batches[i].ellipses.clear();
+  }
+  numBatches = 0;
+}
+
+//------------------------------------------------------------------------
+DrawBatch &DrawBatcher::batchFor(DrawBatchKind kind, const LayoutColor &color,
+                                 double lineWidth) {
+  // A frame has a handful of strokes; a linear scan finds them
+  for (size_t i = 0; i < numBatches; i++) {
+    DrawBatch &batch = batches[i];
+    if (batch.kind == kind && batch.lineWidth == lineWidth &&
+        batch.color.red == color.red && batch.color.green == color.green &&
+        batch.color.blue == color.blue && batch.color.alpha == color.alpha)
+      return batch;
+  }
+
+  if (numBatches == batches.size())
+    batches.emplace_back();
+  DrawBatch &batch = batches[numBatches++];
+  batch.kind = kind;
+  batch.color = color;
+  batch.lineWidth = lineWidth;
+  return batch;
+}
+
+//------------------------------------------------------------------------
+void DrawBatcher::addLine(DrawBatch &batch, double x1, double y1, double x2,
+                          double y2) {
+  batch.segments.push_back({x1, y1, x2, y2});
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "notation_layout.h"
+#include <cstddef>
+#include <vector>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// Draw batches
+//------------------------------------------------------------------------
+struct LineSegment {
+  double x1 = 0.0;
+  double y1 = 0.0;
+  double x2 = 0.0;
+  double y2 = 0.0;
+};
+
+enum class DrawBatchKind : uint8_t {
+  kLines,          // segments, stroked lineWidth wide
+  kFilledEllipses, // ellipses, filled
+  kStrokedEllipses // ellipses, stroked lineWidth wide
+};
+
+struct DrawBatch {
+  DrawBatchKind kind = DrawBatchKind::kLines;
+  LayoutColor color;
+  double lineWidth = 0.0;
+  std::vector<LineSegment> segments;
+  std::vector<LayoutRect> ellipses;
+};
+
+//------------------------------------------------------------------------
+// DrawBatcher - Line and ellipse geometry of display items, by stroke
+//
+// Staff and ledger lines, accidental strokes and note heads are turned
+// into their lines and ellipses and gathered into one batch per kind,
+// color and line width, so a backend can submit each batch with a single
+// call and a single state change. Batches keep their storage when
+// cleared. Items are opaque and one color at a time, so drawing a batch
+// out of item order looks the same; text and filled rects are left to
+// the caller, who flushes before drawing them to keep their stacking.
+//------------------------------------------------------------------------
+class DrawBatcher {
+public:
+  // Adds the item's geometry offset by origin; false if it has none
+  // (text, filled rects)
+  bool add(const DisplayItem &item, double originX, double originY);
+  void clear();
+
+  bool isEmpty() const { return numBatches == 0; }
+  size_t getNumBatches() const { return numBatches; }
+  const DrawBatch &getBatch(size_t index) const { return batches[index]; }
+
+private:
+  DrawBatch &batchFor(DrawBatchKind kind, const LayoutColor &color,
+                     double lineWidth);
+  void addLine(DrawBatch &batch, double x1, double y1, double x2,
+               double y2);
+
+  std::vector<DrawBatch> batches; // Only the first numBatches are in use
+  size_t numBatches = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
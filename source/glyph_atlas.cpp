@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "glyph_atlas.h"
+#include "batch_renderer.h"
+#include "vstgui/lib/coffscreencontext.h"
+#include "vstgui/lib/cpoint.h"
+#include "vstgui/lib/crect.h"
+
+#include <cmath>
+
+namespace Ursulean {
+
+namespace {
+const DisplayItemType kCellTypes[] = {
+    DisplayItemType::kNoteHead, DisplayItemType::kSharp,
+    DisplayItemType::kFlat, DisplayItemType::kNatural,
+    DisplayItemType::kLedgerLine};
+
+// Rounds to the device pixel grid
+double snap(double value, double scaleFactor) {
+  return std::round(value * scaleFactor) / scaleFactor;
+}
+} // namespace
+
+//------------------------------------------------------------------------
+bool GlyphAtlas::prepare(const NotationLayout &layout, double scaleFactor) {
+  bool upToDate = bitmap && this->scaleFactor == scaleFactor;
+  for (int i = 0; i < kNumCells && upToDate; i++) {
+    upToDate = isSameSymbol(cells[i].symbol,
+                            layout.makeSymbol(kCellTypes[i], 0.0, 0.0));
+  }
+  if (upToDate)
+    return true;
+
+  // Cells side by side, each whole device pixels wide and a pixel apart
+  double atlasWidth = 0.0;
+  double atlasHeight = 0.0;
+  for (int i = 0; i < kNumCells; i++) {
+    Cell &cell = cells[i];
+    cell.symbol = layout.makeSymbol(kCellTypes[i], 0.0, 0.0);
+    LayoutRect bounds = NotationLayout::getItemBounds(cell.symbol);
+    cell.bounds = {std::floor(bounds.left * scaleFactor) / scaleFactor,
+                   std::floor(bounds.top * scaleFactor) / scaleFactor,
+                   std::ceil(bounds.right * scaleFactor) / scaleFactor,
+                   std::ceil(bounds.bottom * scaleFactor) / scaleFactor};
+    cell.atlasLeft = atlasWidth;
+    atlasWidth += cell.bounds.right - cell.bounds.left + 1.0 / scaleFactor;
+    atlasHeight = std::max(atlasHeight, cell.bounds.bottom - cell.bounds.top);
+  }
+
+  this->scaleFactor = scaleFactor;
+  bitmap = nullptr;
+  auto offscreen = VSTGUI::COffscreenContext::create(
+      VSTGUI::CPoint(atlasWidth, atlasHeight), scaleFactor);
+  if (!offscreen)
+    return false;
+
+  DrawBatcher batcher;
+  for (const Cell &cell : cells) {
+    batcher.add(cell.symbol, cell.atlasLeft - cell.bounds.left,
+                -cell.bounds.top);
+  }
+  offscreen->beginDraw();
+  offscreen->setDrawMode(VSTGUI::kAntiAliasing);
+  offscreen->setLineStyle(VSTGUI::kLineSolid);
+  BatchRenderer().draw(offscreen, batcher);
+  offscreen->endDraw();
+
+  bitmap = offscreen->getBitmap();
+  return bitmap != nullptr;
+}
+
+//------------------------------------------------------------------------
+void GlyphAtlas::clear() {
+  bitmap = nullptr;
+  scaleFactor = 0.0;
+}
+
+//------------------------------------------------------------------------
+bool GlyphAtlas::draw(VSTGUI::CDrawContext *context, const DisplayItem &item,
+                      double originX, double originY) const {
+  int index = getCellIndex(item.type);
+  if (!bitmap || index < 0)
+    return false;
+
+  // Symbols of a type only differ by position, which moves all corners
+  const Cell &cell = cells[index];
+  DisplayItem moved = cell.symbol;
+  double dx = item.left - cell.symbol.left;
+  double dy = item.top - cell.symbol.top;
+  moved.left += dx;
+  moved.right += dx;
+  moved.top += dy;
+  moved.bottom += dy;
+  if (!isSameSymbol(moved, item))
+    return false;
+
+  // Whole device pixels keep the blit a plain copy
+  double left = snap(originX + dx + cell.bounds.left, scaleFactor);
+  double top = snap(originY + dy + cell.bounds.top, scaleFactor);
+  VSTGUI::CRect dest(left, top, left + cell.bounds.right - cell.bounds.left,
+                     top + cell.bounds.bottom - cell.bounds.top);
+  bitmap->draw(context, dest, VSTGUI::CPoint(cell.atlasLeft, 0.0));
+  return true;
+}
+
+//------------------------------------------------------------------------
+int GlyphAtlas::getCellIndex(DisplayItemType type) {
+  for (int i = 0; i < kNumCells; i++) {
+    if (kCellTypes[i] == type)
+      return i;
+  }
+  return -1;
+}
+
+//------------------------------------------------------------------------
+bool GlyphAtlas::isSameSymbol(const DisplayItem &a, const DisplayItem &b) {
+  // Corners are compared loosely, they went through different sums
+  const double kTolerance = 1e-6;
+  return a.type == b.type && a.size == b.size &&
+         a.lineWidth == b.lineWidth && a.color.red == b.color.red &&
+         a.color.green == b.color.green && a.color.blue == b.color.blue &&
+         a.color.alpha == b.color.alpha &&
+         std::abs(a.left - b.left) < kTolerance &&
+         std::abs(a.top - b.top) < kTolerance &&
+         std::abs(a.right - b.right) < kTolerance &&
+         std::abs(a.bottom - b.bottom) < kTolerance;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
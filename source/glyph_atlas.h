@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "notation_layout.h"
+#include "vstgui/lib/cbitmap.h"
+#include "vstgui/lib/cdrawcontext.h"
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// GlyphAtlas - Pre-rasterized note heads, accidentals and ledger lines
+//
+// One offscreen bitmap holds a cell per symbol type, rendered as vector
+// geometry (see DrawBatcher) at the sizes of the current layout and the
+// context's scale factor. Drawing a symbol is then a blit of its cell.
+// prepare() rebuilds the bitmap only when the view size (and with it the
+// symbol sizes) or the scale factor changed.
+//------------------------------------------------------------------------
+class GlyphAtlas {
+public:
+  // Makes the cells match the layout's symbols at this scale factor;
+  // false if no offscreen context could be created
+  bool prepare(const NotationLayout &layout, double scaleFactor);
+  void clear();
+
+  // Blits the symbol at its position offset by origin; false if the item
+  // is no symbol or differs from its cell (draw it as geometry then)
+  bool draw(VSTGUI::CDrawContext *context, const DisplayItem &item,
+            double originX, double originY) const;
+
+private:
+  static constexpr int kNumCells = 5; // Note head, #, b, natural, ledger
+
+  struct Cell {
+    DisplayItem symbol; // Made at (0, 0)
+    LayoutRect bounds;  // Of symbol, widened to whole device pixels
+    double atlasLeft = 0.0;
+  };
+
+  static int getCellIndex(DisplayItemType type);
+  static bool isSameSymbol(const DisplayItem &a, const DisplayItem &b);
+
+  Cell cells[kNumCells];
+  double scaleFactor = 0.0;
+  VSTGUI::SharedPointer<VSTGUI::CBitmap> bitmap;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,55 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "key_detection_thread.h"
+
+#include <chrono>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+void KeyDetectionThread::start() {
+  if (running.exchange(true))
+    return;
+  thread = std::thread([this] {
+    while (running.load(std::memory_order_acquire)) {
+      process();
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(kIntervalMilliseconds));
+    }
+  });
+}
+
+//------------------------------------------------------------------------
+void KeyDetectionThread::stop() {
+  if (!running.exchange(false))
+    return;
+  thread.join();
+}
+
+//------------------------------------------------------------------------
+void KeyDetectionThread::process() {
+  NoteEvent event;
+  while (notes.popNoteEvent(event)) {
+    switch (event.type) {
+    case NoteEvent::kNoteOn:
+      detector.noteOn(event.pitch, event.velocity, event.sampleTime);
+      break;
+    case NoteEvent::kNoteOff:
+      detector.noteOff(event.pitch, event.sampleTime);
+      break;
+    case NoteEvent::kReset:
+      detector.reset();
+      break;
+    }
+  }
+
+  // The detector only switches after a new key has led for a good fraction
+  // of a second, so scoring at this rate loses nothing
+  if (detector.update(notes.getNoteEventTime()))
+    notes.setDetectedKey(detector.getKeySignature());
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
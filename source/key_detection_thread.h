@@ -0,0 +1,47 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_detector.h"
+#include "note_processor.h"
+#include <atomic>
+#include <thread>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// KeyDetectionThread - Runs the KeyDetector off the audio thread
+//
+// Drains the NoteProcessor's note events into the detector every
+// kIntervalMilliseconds and hands each new key back through
+// setDetectedKey(), so scoring never lands in process(). The audio thread
+// only pushes events and reads an atomic. Tools and benchmarks without a
+// thread call process() themselves.
+//------------------------------------------------------------------------
+class KeyDetectionThread {
+public:
+  explicit KeyDetectionThread(NoteProcessor &notes) : notes(notes) {}
+  ~KeyDetectionThread() { stop(); }
+
+  // Only while stopped
+  void setSampleRate(double rate) { detector.setSampleRate(rate); }
+
+  void start();
+  void stop();
+
+  // One pass: everything queued, then a rescore at the audio thread's time
+  void process();
+
+private:
+  static constexpr int kIntervalMilliseconds = 10;
+
+  NoteProcessor &notes;
+  KeyDetector detector; // Detection thread only
+  std::thread thread;
+  std::atomic<bool> running{false};
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,269 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "key_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Ursulean {
+
+namespace {
+// Krumhansl-Kessler probe tone ratings, tonic first
+const float kMajorProfile[12] = {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f,
+                                 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f};
+const float kMinorProfile[12] = {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f,
+                                 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f};
+
+// All 24 profiles, centred and scaled to unit length so a dot product with
+// a centred histogram is the correlation up to the histogram's own norm.
+// Stored pitch class major, key minor: scoring walks 24 contiguous floats
+// per pitch class, which compilers turn into a few vector multiply-adds.
+struct KeyProfiles {
+  alignas(32) float weights[12][kNumDetectedKeys];
+
+  KeyProfiles() {
+    for (int mode = 0; mode < 2; mode++) {
+      const float *profile = mode ? kMinorProfile : kMajorProfile;
+      float mean = 0.f;
+      for (int i = 0; i < 12; i++)
+        mean += profile[i] / 12.f;
+      float norm = 0.f;
+      for (int i = 0; i < 12; i++)
+        norm += (profile[i] - mean) * (profile[i] - mean);
+      norm = std::sqrt(norm);
+
+      for (int tonic = 0; tonic < 12; tonic++) {
+        for (int pc = 0; pc < 12; pc++) {
+          weights[pc][mode * 12 + tonic] =
+              (profile[(pc - tonic + 12) % 12] - mean) / norm;
+        }
+      }
+    }
+  }
+};
+
+const KeyProfiles keyProfiles;
+
+// Rebase the running gain before it gets anywhere near overflowing
+const double kMaxGain = 1e12;
+} // namespace
+
+//------------------------------------------------------------------------
+// KeyDetector
+//------------------------------------------------------------------------
+KeyDetector::KeyDetector() { setHalfLife(halfLifeSeconds); }
+
+//------------------------------------------------------------------------
+void KeyDetector::setSampleRate(double newSampleRate) {
+  if (newSampleRate > 0.0) {
+    sampleRate = newSampleRate;
+    setHalfLife(halfLifeSeconds);
+  }
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::setHalfLife(double seconds) {
+  halfLifeSeconds = std::max(seconds, 0.01);
+  decayPerSample = std::log(2.0) / (halfLifeSeconds * sampleRate);
+  reset(); // Stored bins are only meaningful for the old rate
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::reset() {
+  hasTime = false;
+  gainOrigin = gainTime = 0;
+  gain = 1.0;
+  scaledWeights.fill(0.0);
+  binGains.fill(1.0);
+  soundingVelocity.fill(0.0);
+  noteVelocities.fill(0.f);
+  heldNotes.clear();
+  currentKey = DetectedKey();
+  keyValid = false;
+  candidateKey = -1;
+  candidateSince = 0;
+  hasScored = false;
+  lastScoreTime = 0;
+}
+
+//------------------------------------------------------------------------
+double KeyDetector::gainAt(int64_t sampleTime) const {
+  return std::exp(decayPerSample *
+                  static_cast<double>(sampleTime - gainOrigin));
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::advanceTo(int64_t sampleTime) {
+  if (!hasTime) {
+    hasTime = true; // First event defines the time base
+    gainOrigin = gainTime = sampleTime;
+    return;
+  }
+  if (sampleTime <= gainTime)
+    return; // Same instant, or the clock stepped back: keep the last gain
+
+  gainTime = sampleTime;
+  gain = gainAt(sampleTime);
+
+  if (gain > kMaxGain) {
+    // Settle every bin at the current gain, then divide it back out.
+    // Happens once every few minutes at most.
+    for (int pc = 0; pc < 12; pc++) {
+      scaledWeights[pc] +=
+          soundingVelocity[pc] * (gain - binGains[pc]) / decayPerSample;
+      scaledWeights[pc] /= gain;
+      binGains[pc] = 1.0;
+    }
+    gainOrigin = sampleTime;
+    gain = 1.0;
+  }
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::noteOn(int pitch, float velocity, int64_t sampleTime) {
+  if (pitch < 0 || pitch >= kNumMidiNotes)
+    return;
+  advanceTo(sampleTime);
+
+  // Close the bin's sounding integral up to now, then change its rate
+  int pc = pitch % 12;
+  scaledWeights[pc] +=
+      soundingVelocity[pc] * (gain - binGains[pc]) / decayPerSample;
+  binGains[pc] = gain;
+
+  if (heldNotes.test(pitch))
+    soundingVelocity[pc] -= noteVelocities[pitch]; // Retriggered
+  soundingVelocity[pc] += velocity;
+  noteVelocities[pitch] = velocity;
+  heldNotes.set(pitch);
+
+  // The attack counts on its own, so short notes still register
+  scaledWeights[pc] += velocity * kOnsetSeconds * sampleRate * gain;
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::noteOff(int pitch, int64_t sampleTime) {
+  if (pitch < 0 || pitch >= kNumMidiNotes || !heldNotes.test(pitch))
+    return;
+  advanceTo(sampleTime);
+
+  int pc = pitch % 12;
+  scaledWeights[pc] +=
+      soundingVelocity[pc] * (gain - binGains[pc]) / decayPerSample;
+  binGains[pc] = gain;
+
+  soundingVelocity[pc] =
+      std::max(0.0, soundingVelocity[pc] - noteVelocities[pitch]);
+  heldNotes.reset(pitch);
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::getHistogram(int64_t sampleTime,
+                               float histogram[12]) const {
+  double now = sampleTime > gainTime ? gainAt(sampleTime) : gain;
+  double sounding = 1.0 / decayPerSample;
+  double unscale = 1.0 / now;
+  for (int pc = 0; pc < 12; pc++) {
+    double weight = scaledWeights[pc] +
+                    soundingVelocity[pc] * (now - binGains[pc]) * sounding;
+    histogram[pc] = static_cast<float>(weight * unscale);
+  }
+}
+
+//------------------------------------------------------------------------
+void KeyDetector::scoreKeys(const float histogram[12],
+                            float scores[kNumDetectedKeys]) const {
+  // Accumulate locally: writing through scores directly would have to
+  // assume it aliases the inputs, which stops the loop vectorizing
+  alignas(32) float sums[kNumDetectedKeys] = {};
+  for (int pc = 0; pc < 12; pc++) {
+    const float weight = histogram[pc];
+    const float *profileRow = keyProfiles.weights[pc];
+    for (int k = 0; k < kNumDetectedKeys; k++)
+      sums[k] += weight * profileRow[k];
+  }
+  for (int k = 0; k < kNumDetectedKeys; k++)
+    scores[k] = sums[k];
+}
+
+//------------------------------------------------------------------------
+bool KeyDetector::update(int64_t sampleTime) {
+  // Keys only switch after kHoldSeconds, so scoring on every (possibly
+  // tiny) block would buy nothing
+  if (hasScored && sampleTime >= lastScoreTime &&
+      static_cast<double>(sampleTime - lastScoreTime) <
+          kScoreSeconds * sampleRate)
+    return false;
+  hasScored = true;
+  lastScoreTime = sampleTime;
+
+  advanceTo(sampleTime);
+
+  float histogram[12];
+  getHistogram(gainTime, histogram);
+
+  // Norm of the centred histogram turns the scores into correlations
+  float mean = 0.f;
+  for (int pc = 0; pc < 12; pc++)
+    mean += histogram[pc] / 12.f;
+  float variance = 0.f;
+  for (int pc = 0; pc < 12; pc++)
+    variance += (histogram[pc] - mean) * (histogram[pc] - mean);
+  if (variance <= 1e-12f)
+    return false; // Silence, or all pitch classes alike
+  float norm = std::sqrt(variance);
+
+  float scores[kNumDetectedKeys];
+  scoreKeys(histogram, scores);
+  int best = 0;
+  for (int k = 1; k < kNumDetectedKeys; k++) {
+    if (scores[k] > scores[best])
+      best = k;
+  }
+  float bestCorrelation = scores[best] / norm;
+
+  int current = currentKey.tonic + (currentKey.isMinor ? 12 : 0);
+  if (keyValid && best == current) {
+    currentKey.correlation = bestCorrelation;
+    candidateKey = -1;
+    return false;
+  }
+
+  float lead = keyValid ? bestCorrelation - scores[current] / norm : 1.f;
+  if (bestCorrelation < kMinCorrelation || lead < kSwitchMargin) {
+    candidateKey = -1;
+    return false;
+  }
+
+  // A challenger has to stay ahead for a while before it takes over
+  if (candidateKey != best) {
+    candidateKey = best;
+    candidateSince = gainTime;
+  }
+  if (static_cast<double>(gainTime - candidateSince) <
+      kHoldSeconds * sampleRate)
+    return false;
+
+  currentKey.tonic = best % 12;
+  currentKey.isMinor = best >= 12;
+  currentKey.correlation = bestCorrelation;
+  keyValid = true;
+  candidateKey = -1;
+  return true;
+}
+
+//------------------------------------------------------------------------
+KeySignature KeyDetector::keySignatureFor(int tonic, bool isMinor) {
+  // Indexed by the pitch class of the (relative) major tonic
+  static const KeySignature kSignatures[12] = {
+      kCMajor,      kDflatMajor, kDMajor,     kEflatMajor,
+      kEMajor,      kFMajor,     kFSharpMajor, kGMajor,
+      kAflatMajor,  kAMajor,     kBflatMajor, kBMajor};
+  int majorTonic = (tonic + (isMinor ? 3 : 0)) % 12;
+  return kSignatures[(majorTonic + 12) % 12];
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "note_state.h"
+#include <array>
+#include <cstdint>
+
+namespace Ursulean {
+
+// Number of keys scored: 12 major followed by 12 minor
+static constexpr int kNumDetectedKeys = 24;
+
+// Key as detected from the notes; the signature is derived from it
+struct DetectedKey {
+  int tonic = 0;          // Pitch class 0-11 (C = 0)
+  bool isMinor = false;
+  float correlation = 0.f; // Fit of the note histogram to the key (-1..1)
+};
+
+//------------------------------------------------------------------------
+// KeyDetector - Streaming key estimation (Krumhansl-Schmuckler profiles)
+//
+// Keeps a pitch-class histogram in which every note counts by velocity and
+// by how long it sounds, fading exponentially with time. The fade is
+// applied through a single running gain instead of touching all bins, so
+// noteOn()/noteOff() only update the one pitch class involved. update()
+// scores the histogram against all 24 key profiles and only switches keys
+// once a new key has clearly and consistently won.
+//
+// Nothing allocates; all methods are safe on the audio thread.
+//------------------------------------------------------------------------
+class KeyDetector {
+public:
+  KeyDetector();
+
+  void setSampleRate(double sampleRate);
+  // Time after which a note's weight has halved
+  void setHalfLife(double seconds);
+
+  // velocity in 0..1. Times are in samples on any monotonic clock.
+  void noteOn(int pitch, float velocity, int64_t sampleTime);
+  void noteOff(int pitch, int64_t sampleTime);
+
+  // Rescore at sampleTime, at most once per kScoreSeconds. Returns true
+  // when the detected key changed.
+  bool update(int64_t sampleTime);
+
+  // Forget all notes and the detected key
+  void reset();
+
+  bool hasKey() const { return keyValid; }
+  const DetectedKey &getKey() const { return currentKey; }
+  KeySignature getKeySignature() const {
+    return keySignatureFor(currentKey.tonic, currentKey.isMinor);
+  }
+
+  // Current histogram value of each pitch class, decayed to sampleTime
+  void getHistogram(int64_t sampleTime, float histogram[12]) const;
+
+  // Major key signature of a key; minor keys use their relative major.
+  // Enharmonic choices favour the signature with fewer accidentals.
+  static KeySignature keySignatureFor(int tonic, bool isMinor);
+
+private:
+  void advanceTo(int64_t sampleTime);
+  double gainAt(int64_t sampleTime) const;
+  void scoreKeys(const float histogram[12], float scores[24]) const;
+
+  // Switching rules
+  static constexpr float kSwitchMargin = 0.05f;   // Correlation lead needed
+  static constexpr float kMinCorrelation = 0.4f;  // Ignore weak evidence
+  static constexpr double kHoldSeconds = 0.75;    // Lead must last this long
+  static constexpr double kOnsetSeconds = 0.1;    // Weight of the attack
+  static constexpr double kScoreSeconds = 0.01;   // Rescoring interval
+
+  double sampleRate = 44100.0;
+  double halfLifeSeconds = 8.0;
+  double decayPerSample = 0.0; // ln(2) / half life in samples
+
+  // Histogram bins are stored multiplied by the running gain
+  // exp(decayPerSample * (t - gainOrigin)), so fading costs nothing per bin
+  bool hasTime = false; // Set by the first event after reset()
+  int64_t gainOrigin = 0;
+  int64_t gainTime = 0;
+  double gain = 1.0;
+  std::array<double, 12> scaledWeights{};
+  std::array<double, 12> binGains{};         // Gain when the bin was settled
+  std::array<double, 12> soundingVelocity{}; // Sum over held notes
+  std::array<float, kNumMidiNotes> noteVelocities{};
+  NoteMask heldNotes;
+
+  // Detection state
+  DetectedKey currentKey;
+  bool keyValid = false;
+  int candidateKey = -1;
+  int64_t candidateSince = 0;
+  bool hasScored = false;
+  int64_t lastScoreTime = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
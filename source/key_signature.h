@@ -26,4 +26,11 @@ enum KeySignature {
   kNumKeySigs = 15
 };
 
+// Number of sharps or flats in the signature
+constexpr int getNumAccidentals(KeySignature key) {
+  return key >= kFMajor ? key - kFMajor + 1 : static_cast<int>(key);
+}
+
+constexpr bool usesFlats(KeySignature key) { return key >= kFMajor; }
+
 } // namespace Ursulean
\ No newline at end of file
@@ -0,0 +1,47 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "layout_cache.h"
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+LayoutCache::LayoutCache(size_t capacity)
+    : entries(capacity > 0 ? capacity : 1) {}
+
+//------------------------------------------------------------------------
+const NotationLayout &LayoutCache::layout(const NoteMask &notes,
+                                          KeySignature key, double width,
+                                          double height) {
+  // A handful of entries: a linear scan beats any index
+  Entry *victim = &entries[0];
+  for (Entry &entry : entries) {
+    if (entry.lastUse != 0 && entry.notes == notes && entry.key == key &&
+        entry.width == width && entry.height == height) {
+      entry.lastUse = ++useCount;
+      hits++;
+      return entry.layout;
+    }
+    if (entry.lastUse < victim->lastUse)
+      victim = &entry;
+  }
+
+  misses++;
+  victim->notes = notes;
+  victim->key = key;
+  victim->width = width;
+  victim->height = height;
+  victim->lastUse = ++useCount;
+  victim->layout.layout(notes, key, width, height);
+  return victim->layout;
+}
+
+//------------------------------------------------------------------------
+void LayoutCache::clear() {
+  for (Entry &entry : entries)
+    entry.lastUse = 0;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "notation_layout.h"
+#include "note_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// LayoutCache - The most recently used finished layouts
+//
+// Players come back to the same few voicings all the time, so finished
+// layouts are kept by note mask, key and view size. A repeated chord
+// returns its layout as is; a new one is laid out into the least recently
+// used slot, reusing that slot's storage. Layouts are in view points, so
+// the content scale factor plays no part.
+//
+// A returned layout stays valid until the next call to layout().
+//------------------------------------------------------------------------
+class LayoutCache {
+public:
+  static constexpr size_t kDefaultCapacity = 16;
+
+  explicit LayoutCache(size_t capacity = kDefaultCapacity);
+
+  const NotationLayout &layout(const NoteMask &notes, KeySignature key,
+                               double width, double height);
+
+  void clear();
+
+  // For tuning the capacity
+  size_t getCapacity() const { return entries.size(); }
+  uint64_t getHits() const { return hits; }
+  uint64_t getMisses() const { return misses; }
+  void resetCounters() { hits = misses = 0; }
+
+private:
+  struct Entry {
+    NoteMask notes;
+    KeySignature key = kCMajor;
+    double width = 0.0;
+    double height = 0.0;
+    uint64_t lastUse = 0; // 0 while empty
+    NotationLayout layout;
+  };
+
+  std::vector<Entry> entries; // Never resized, so layouts don't move
+  uint64_t useCount = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
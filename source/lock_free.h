@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// SpscQueue - Wait-free single-producer/single-consumer ring buffer
+//
+// push() and pop() never block and never allocate. The producer and the
+// consumer must each be a single thread (e.g. audio thread -> worker).
+//------------------------------------------------------------------------
+template <typename T, size_t Capacity> class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscQueue capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscQueue elements must be trivially copyable");
+
+public:
+  // Producer side. Returns false (and drops the item) when the queue is full.
+  bool push(const T &item) {
+    const size_t tail = tailIndex.load(std::memory_order_relaxed);
+    const size_t head = headIndex.load(std::memory_order_acquire);
+    if (tail - head >= Capacity)
+      return false;
+
+    buffer[tail & (Capacity - 1)] = item;
+    tailIndex.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when there is nothing to read.
+  bool pop(T &item) {
+    const size_t head = headIndex.load(std::memory_order_relaxed);
+    const size_t tail = tailIndex.load(std::memory_order_acquire);
+    if (head == tail)
+      return false;
+
+    item = buffer[head & (Capacity - 1)];
+    headIndex.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return headIndex.load(std::memory_order_acquire) ==
+           tailIndex.load(std::memory_order_acquire);
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+private:
+  std::array<T, Capacity> buffer{};
+  // Keep the two counters on separate cache lines so the producer and the
+  // consumer don't invalidate each other on every operation
+  alignas(64) std::atomic<size_t> headIndex{0};
+  alignas(64) std::atomic<size_t> tailIndex{0};
+};
+
+//------------------------------------------------------------------------
+// SnapshotPublisher - Sequence-locked value published by a single writer
+//
+// publish() is wait-free. read() never blocks the writer; a reader that
+// races with a publish simply retries, which only happens while the writer
+// is copying a handful of words. Storage is kept in atomic words so the
+// concurrent copy is well defined.
+//------------------------------------------------------------------------
+template <typename T> class SnapshotPublisher {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Snapshots must be trivially copyable");
+
+public:
+  SnapshotPublisher() { publish(T{}); }
+
+  // Writer side - only ever called from one thread at a time
+  void publish(const T &value) {
+    std::array<uint64_t, kNumWords> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    const uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed); // odd: write pending
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kNumWords; i++)
+      storage[i].store(words[i], std::memory_order_relaxed);
+    sequence.store(seq + 2, std::memory_order_release); // even: stable
+  }
+
+  // Reader side - safe from any number of threads
+  T read() const {
+    std::array<uint64_t, kNumWords> words{};
+    for (;;) {
+      const uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1)
+        continue; // Writer is mid-publish
+      for (size_t i = 0; i < kNumWords; i++)
+        words[i] = storage[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before)
+        break;
+    }
+
+    T value;
+    std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+    return value;
+  }
+
+  // Number of publishes so far, usable as a cheap "has it changed" check
+  uint32_t version() const {
+    return sequence.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static constexpr size_t kNumWords = (sizeof(T) + 7) / 8;
+
+  std::array<std::atomic<uint64_t>, kNumWords> storage{};
+  std::atomic<uint32_t> sequence{0};
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
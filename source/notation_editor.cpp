@@ -3,12 +3,37 @@
 //------------------------------------------------------------------------
 
 #include "notation_editor.h"
+#include "chord_capture.h"
+#include "chord_export.h"
 #include "controller.h"
+#include "vstgui/lib/cfileselector.h"
 #include "vstgui/lib/controls/coptionmenu.h"
 #include "vstgui/lib/controls/ctextlabel.h"
 
 namespace Ursulean {
 
+namespace {
+// Entries of the export menu; the first one is only its title
+enum ExportFormat {
+  kExportTitle = 0,
+  kExportMusicXml,
+  kExportMidi,
+  kExportCapture
+};
+
+struct ExportFormatInfo {
+  const char *title;
+  const char *description;
+  const char *extension;
+  const char *defaultName;
+};
+const ExportFormatInfo kExportFormats[] = {
+    {"Export...", "", "", ""},
+    {"MusicXML...", "MusicXML", "musicxml", "chords.musicxml"},
+    {"MIDI File...", "Standard MIDI File", "mid", "chords.mid"},
+    {"Chord Capture...", "Chord Capture", "chords", "chords.chords"}};
+} // namespace
+
 //------------------------------------------------------------------------
 NotationEditor::NotationEditor(void *controller,
                                VSTGUI::UTF8StringPtr templateName,
@@ -30,7 +55,7 @@ bool NotationEditor::open(void *parent,
     frame->removeAll();
 
     // Set frame size (increased height to accommodate dropdown)
-    VSTGUI::CRect frameSize(0, 0, 600, 450);
+    VSTGUI::CRect frameSize(0, 0, 600, 640);
     frame->setSize(frameSize.getWidth(), frameSize.getHeight());
 
     // Create a label for the key signature dropdown
@@ -67,15 +92,45 @@ bool NotationEditor::open(void *parent,
     keySignatureMenu->setValue(0.0f);
     frame->addView(keySignatureMenu);
 
+    // Let the key follow what is played
+    VSTGUI::CRect autoKeyRect(310, 10, 420, 30);
+    autoKeyCheckBox =
+        new VSTGUI::CCheckBox(autoKeyRect, this, kAutoKeyParam, "Auto Key");
+    autoKeyCheckBox->setFontColor(VSTGUI::CColor(0, 0, 0, 255));
+    frame->addView(autoKeyCheckBox);
+
+    // Save what the timeline has captured
+    VSTGUI::CRect exportRect(430, 10, 590, 30);
+    exportMenu = new VSTGUI::COptionMenu(exportRect, this, -1);
+    for (const auto &format : kExportFormats)
+      exportMenu->addEntry(format.title);
+    exportMenu->setValue(kExportTitle);
+    frame->addView(exportMenu);
+
     // Create our notation view (positioned below the dropdown)
     VSTGUI::CRect notationRect(10, 50, 590, 440);
     notationView = new NotationView(notationRect);
     frame->addView(notationView);
 
-    // Set initial key signature in notation view
+    // The chords played last, below the staff
+    VSTGUI::CRect historyRect(10, 450, 590, 530);
+    // And the song's chords from the transport position
+    VSTGUI::CRect timelineRect(10, 540, 590, 630);
     if (auto controller =
             dynamic_cast<NotationChordHelperController *>(getController())) {
+      historyView =
+          new ChordHistoryView(historyRect, controller->getChordHistory());
+      frame->addView(historyView);
+      timelineView =
+          new ChordTimelineView(timelineRect, controller->getChordTimeline());
+      frame->addView(timelineView);
+      timelineView->update(); // Anything recorded while it was closed
+
+      // Start from the controller's current key, notes and auto key
       notationView->setKeySignature(controller->getCurrentKeySignature());
+      notationView->setActiveNotes(controller->getCurrentNotes());
+      autoKeyCheckBox->setValue(
+          static_cast<float>(controller->getParamNormalized(kAutoKeyParam)));
     }
   }
 
@@ -84,19 +139,122 @@ bool NotationEditor::open(void *parent,
 
 //------------------------------------------------------------------------
 void NotationEditor::close() {
+  if (displayTimer) {
+    displayTimer->stop();
+    displayTimer = nullptr;
+  }
+  displayTimerRunning = false;
+  hasPendingNotes = false;
+
   if (notationView) {
     notationView = nullptr; // The frame will handle deletion
   }
   if (keySignatureMenu) {
     keySignatureMenu = nullptr; // The frame will handle deletion
   }
+  historyView = nullptr;     // The frame will handle deletion
+  timelineView = nullptr;    // The frame will handle deletion
+  autoKeyCheckBox = nullptr; // The frame will handle deletion
+  exportMenu = nullptr;      // The frame will handle deletion
   VST3Editor::close();
 }
 
 //------------------------------------------------------------------------
-void NotationEditor::setActiveNotes(const std::vector<int> &notes) {
+void NotationEditor::setActiveNotes(const NoteMask &notes) {
+  if (!notationView)
+    return;
+
+  pendingNotes = notes;
+  hasPendingNotes = true;
+  if (!displayTimerRunning) {
+    if (!displayTimer) {
+      displayTimer = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer>(
+          [this](VSTGUI::CVSTGUITimer *) { onDisplayFrame(); },
+          kDisplayFrameMs, false);
+    }
+    displayTimerRunning = displayTimer->start();
+    if (!displayTimerRunning) {
+      onDisplayFrame(); // No timer; show the notes right away
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+void NotationEditor::onDisplayFrame() {
+  if (!hasPendingNotes) {
+    // A whole frame without changes: sleep until the next one
+    if (displayTimer) {
+      displayTimer->stop();
+    }
+    displayTimerRunning = false;
+    return;
+  }
+
+  hasPendingNotes = false;
   if (notationView) {
-    notationView->setActiveNotes(notes);
+    notationView->setActiveNotes(pendingNotes);
+  }
+  // Chords enter the history and timeline on note changes, so no extra
+  // timer is needed
+  if (historyView) {
+    historyView->update();
+  }
+  if (timelineView) {
+    timelineView->update();
+  }
+}
+
+//------------------------------------------------------------------------
+void NotationEditor::exportTimeline(int format) {
+  auto controller =
+      dynamic_cast<NotationChordHelperController *>(getController());
+  if (!controller)
+    return;
+  auto *selector = VSTGUI::CNewFileSelector::create(
+      getFrame(), VSTGUI::CNewFileSelector::kSelectSaveFile);
+  if (!selector)
+    return;
+
+  const ExportFormatInfo &info = kExportFormats[format];
+  selector->setTitle("Export Chords");
+  selector->setDefaultExtension(
+      VSTGUI::CFileExtension(info.description, info.extension));
+  selector->setDefaultSaveName(info.defaultName);
+
+  // The controller outlives the editor, and the timeline with it; the menu
+  // is kept until the selector is done. Chords are written as they are
+  // read, so even hours of them take only a moment on the UI thread.
+  VSTGUI::SharedPointer<VSTGUI::COptionMenu> menu = exportMenu;
+  selector->run([controller, format, menu](VSTGUI::CNewFileSelector *result) {
+    if (result->getNumSelectedFiles() == 0)
+      return;
+    const char *path = result->getSelectedFile(0);
+    const ChordTimeline &timeline = controller->getChordTimeline();
+    TimelineChordSource source(timeline);
+    ExportOptions options = getExportOptions(timeline.getMeter());
+    bool written = false;
+    if (format == kExportMusicXml)
+      written = writeMusicXml(source, options, path);
+    else if (format == kExportMidi)
+      written = writeMidiFile(source, options, path);
+    else
+      written = writeChordCapture(timeline, path);
+
+    // The writers leave no partial file; the menu title says what happened
+    // until the next export
+    if (auto *title = menu->getEntry(kExportTitle)) {
+      title->setTitle(written ? kExportFormats[kExportTitle].title
+                              : "Export failed");
+      menu->invalid();
+    }
+  });
+  selector->forget();
+}
+
+//------------------------------------------------------------------------
+void NotationEditor::locateTimeline(double position) {
+  if (timelineView) {
+    timelineView->locate(position);
   }
 }
 
@@ -127,6 +285,18 @@ void NotationEditor::valueChanged(VSTGUI::CControl *pControl) {
       controller->setParamNormalized(kKeySignatureParam, normalizedValue);
       controller->performEdit(kKeySignatureParam, normalizedValue);
     }
+  } else if (pControl == exportMenu) {
+    auto format = static_cast<int>(exportMenu->getValue() + 0.5f);
+    exportMenu->setValue(kExportTitle); // A menu of actions, not a setting
+    exportMenu->invalid();
+    if (format != kExportTitle)
+      exportTimeline(format);
+  } else if (pControl == autoKeyCheckBox) {
+    float normalizedValue = autoKeyCheckBox->getValue() >= 0.5f ? 1.f : 0.f;
+    if (auto controller = getController()) {
+      controller->setParamNormalized(kAutoKeyParam, normalizedValue);
+      controller->performEdit(kAutoKeyParam, normalizedValue);
+    }
   }
 
   // Call parent implementation
@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include "chord_history_view.h"
+#include "chord_timeline_view.h"
 #include "key_signature.h"
 #include "notation_view.h"
+#include "vstgui/lib/controls/cbuttons.h"
 #include "vstgui/lib/controls/ccontrol.h"
 #include "vstgui/lib/controls/coptionmenu.h"
+#include "vstgui/lib/cvstguitimer.h"
 #include "vstgui/plugin-bindings/vst3editor.h"
 
 namespace Ursulean {
@@ -26,16 +30,34 @@ public:
                        const VSTGUI::PlatformType &platformType) override;
   void PLUGIN_API close() override;
 
-  // Update the notation display
-  void setActiveNotes(const std::vector<int> &notes);
+  // Update the notation display. Notes are taken as the latest snapshot
+  // and shown on the next display frame, however often they change.
+  void setActiveNotes(const NoteMask &notes);
   void setKeySignature(KeySignature keySignature);
+  // The host's transport jumped to position (quarter notes)
+  void locateTimeline(double position);
 
   // VST3Editor overrides for parameter updates
   void valueChanged(VSTGUI::CControl *pControl) override;
 
 protected:
+  // Runs only while notes are changing
+  void onDisplayFrame();
+  // Asks for a file and saves the chord timeline to it
+  void exportTimeline(int format);
+  static constexpr uint32_t kDisplayFrameMs = 16; // About 60 Hz
+
+  VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> displayTimer;
+  bool displayTimerRunning = false;
+  NoteMask pendingNotes;
+  bool hasPendingNotes = false;
+
   NotationView *notationView = nullptr;
+  ChordHistoryView *historyView = nullptr;
+  ChordTimelineView *timelineView = nullptr;
   VSTGUI::COptionMenu *keySignatureMenu = nullptr;
+  VSTGUI::CCheckBox *autoKeyCheckBox = nullptr;
+  VSTGUI::COptionMenu *exportMenu = nullptr;
 };
 
 //------------------------------------------------------------------------
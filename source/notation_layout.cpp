@@ -0,0 +1,460 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "notation_layout.h"
+
+#include <cmath>
+
+namespace Ursulean {
+
+namespace {
+const LayoutColor kBlack = {0, 0, 0, 255};
+const LayoutColor kBackground = {250, 250, 250, 255}; // Light gray
+const LayoutColor kNoteNameColor = {10, 10, 10, 255};
+} // namespace
+
+//------------------------------------------------------------------------
+// NotationLayout
+//------------------------------------------------------------------------
+NotationLayout::NotationLayout() {
+  items.reserve(kReservedItems);
+  text.reserve(kReservedText);
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layout(const NoteMask &notes, KeySignature key,
+                            double width, double height) {
+  dim = {width, height};
+  keySignature = key;
+  chord = identifyChord(notes);
+  items.clear();
+  text.clear();
+
+  // Clear background
+  DisplayItem background;
+  background.type = DisplayItemType::kFilledRect;
+  background.color = kBackground;
+  background.right = width;
+  background.bottom = height;
+  items.push_back(background);
+
+  layoutStaff();
+  layoutNoteNames(); // On the right side
+  size_t keySignatureStart = items.size();
+  layoutKeySignature();
+  numStaticItems = items.size();
+  keySignatureBounds = getBounds(keySignatureStart, numStaticItems);
+
+  layoutNotes(notes);
+  layoutChordSymbol(); // Above the staff
+  noteBounds = getBounds(numStaticItems, items.size());
+}
+
+//------------------------------------------------------------------------
+LayoutRect NotationLayout::getItemBounds(const DisplayItem &item) {
+  LayoutRect bounds;
+  double size = item.size;
+  switch (item.type) {
+  case DisplayItemType::kLine:
+  case DisplayItemType::kLedgerLine:
+    bounds = {std::min(item.left, item.right), std::min(item.top, item.bottom),
+              std::max(item.left, item.right),
+              std::max(item.top, item.bottom)};
+    break;
+  case DisplayItemType::kSharp:
+    bounds = {item.left, item.top - size * 0.75, item.left + size,
+              item.top + size * 0.75};
+    break;
+  case DisplayItemType::kFlat:
+    bounds = {item.left + size * 0.25, item.top - size, item.left + size,
+              item.top + size * 0.5};
+    break;
+  case DisplayItemType::kNatural:
+    bounds = {item.left + size * 0.125, item.top - size,
+              item.left + size * 0.625, item.top + size};
+    break;
+  default: // Rects, note heads and text fill their bounds
+    bounds = {item.left, item.top, item.right, item.bottom};
+    break;
+  }
+
+  // Half the stroke spills over, plus a pixel for antialiasing
+  double spill = item.lineWidth / 2.0 + 1.0;
+  bounds.left -= spill;
+  bounds.top -= spill;
+  bounds.right += spill;
+  bounds.bottom += spill;
+  return bounds;
+}
+
+//------------------------------------------------------------------------
+LayoutRect NotationLayout::getBounds(size_t first, size_t last) const {
+  LayoutRect bounds;
+  for (size_t i = first; i < last; i++)
+    bounds.unite(getItemBounds(items[i]));
+  return bounds;
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layoutStaff() {
+  double centerY = dim.height / 2.0;
+  double staffLineHeight = dim.staffLineHeight();
+  double grandStaffGap = dim.grandStaffGap();
+
+  // Calculate staff centers - position the grand staff around the window center
+  double trebleStaffCenter =
+      centerY - (grandStaffGap / 2.0) - (staffLineHeight * 2.0);
+  double bassStaffCenter =
+      centerY + (grandStaffGap / 2.0) + (staffLineHeight * 2.0);
+
+  // Position clefs and start of staff lines
+  double staffStartX = dim.leftMargin();
+  double staffEndX = dim.width - dim.rightMargin();
+
+  for (int i = 0; i < 5; i++) {
+    double y = trebleStaffCenter + (staffLineHeight * (2 - i));
+    addLine(staffStartX, y, staffEndX, y, 2.0);
+  }
+  for (int i = 0; i < 5; i++) {
+    double y = bassStaffCenter + (staffLineHeight * (2 - i));
+    addLine(staffStartX, y, staffEndX, y, 2.0);
+  }
+
+  // Unicode clef symbols, the treble clef's curl on the G4 line and the
+  // bass clef's dots around the F3 line
+  double fontSize = dim.clefFontSize();
+  double clefWidth = dim.clefWidth();
+  double y = trebleStaffCenter - staffLineHeight / 2;
+  addText("𝄞", staffStartX, y - fontSize / 2, staffStartX + clefWidth,
+          y + fontSize / 2, fontSize, TextAlign::kCenter, kBlack);
+  y = bassStaffCenter - staffLineHeight / 2;
+  addText("𝄢", staffStartX, y - fontSize / 2, staffStartX + clefWidth,
+          y + fontSize / 2, fontSize * 0.8, TextAlign::kCenter, kBlack);
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layoutNoteNames() {
+  double centerY = dim.height / 2.0;
+  double staffLineHeight = dim.staffLineHeight();
+  double grandStaffGap = dim.grandStaffGap();
+
+  // Calculate staff centers - same as in layoutStaff
+  double trebleStaffCenter =
+      centerY - (grandStaffGap / 2.0) - (staffLineHeight * 2.0) - 1.0;
+  double bassStaffCenter =
+      centerY + (grandStaffGap / 2.0) + (staffLineHeight * 2.0) - 1.0;
+
+  double fontSize = staffLineHeight;
+
+  // Horizontal starting position (right half of staff)
+  double staffRight = dim.width - dim.rightMargin();
+  double staffLeft = dim.leftMargin();
+  double staffMid = (staffLeft + staffRight) / 2.0;
+  double baseX =
+      staffMid + (staffRight - staffMid) * 0.25; // 25% toward right edge
+  double letterSpacing = fontSize * 1.1;         // Space between letters
+
+  // Line letters from the bottom, then the space letters to their right
+  static const char *const trebleLineNotes[] = {"E", "G", "B", "D", "F"};
+  static const char *const trebleSpaceNotes[] = {"F", "A", "C", "E"};
+  static const char *const bassLineNotes[] = {"G", "B", "D", "F", "A"};
+  static const char *const bassSpaceNotes[] = {"A", "C", "E", "G"};
+
+  auto addLetters = [&](const char *const *letters, int count, int column,
+                        double staffCenter, double firstStep) {
+    for (int i = 0; i < count; i++) {
+      double x = baseX + (i + column) * letterSpacing;
+      double y = staffCenter + (staffLineHeight * (firstStep - i));
+      addText(letters[i], x, y - fontSize / 2, x + fontSize, y + fontSize / 2,
+              fontSize, TextAlign::kCenter, kNoteNameColor);
+    }
+  };
+  addLetters(trebleLineNotes, 5, 0, trebleStaffCenter, 2.0);
+  addLetters(trebleSpaceNotes, 4, 5, trebleStaffCenter, 1.5);
+  addLetters(bassLineNotes, 5, 0, bassStaffCenter, 2.0);
+  addLetters(bassSpaceNotes, 4, 5, bassStaffCenter, 1.5);
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layoutKeySignature() {
+  // Where each accidental sits, in the order the signature adds them
+  // Sharp order: F, C, G, D, A, E, B
+  static const int trebleSharpNotes[7] = {77, 72, 79, 74, 69, 76, 71};
+  static const int bassSharpNotes[7] = {53, 48, 55, 50, 45, 52, 47};
+  // Flat order: B, E, A, D, G, C, F
+  static const int trebleFlatNotes[7] = {71, 76, 69, 74, 67, 72, 65};
+  static const int bassFlatNotes[7] = {47, 52, 45, 50, 43, 48, 41};
+
+  int numAccidentals = getNumAccidentals(keySignature);
+  bool flats = usesFlats(keySignature);
+  const int *trebleNotes = flats ? trebleFlatNotes : trebleSharpNotes;
+  const int *bassNotes = flats ? bassFlatNotes : bassSharpNotes;
+  DisplayItemType glyph = flats ? DisplayItemType::kFlat
+                                : DisplayItemType::kSharp;
+
+  double baseX = dim.leftMargin() + dim.clefWidth() + dim.keySignaturePadding();
+  for (int i = 0; i < numAccidentals; i++) {
+    double x = baseX + i * dim.accidentalSpacing();
+
+    // Staff positions of the (white key) notes in C, on both staves
+    items.push_back(makeSymbol(
+        glyph, x,
+        getStaffStepY(spellNote(kCMajor, trebleNotes[i]).staffStep)));
+    items.push_back(makeSymbol(
+        glyph, x, getStaffStepY(spellNote(kCMajor, bassNotes[i]).staffStep)));
+  }
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layoutNotes(const NoteMask &notes) {
+  numNotes = 0;
+  if (!notes.any())
+    return;
+
+  // Spell every note in the current key (one table read each). Lowest
+  // first, which in any one key is also staff step order.
+  notes.forEach(
+      [&](int note) { spellings[numNotes++] = spellNote(keySignature, note); });
+
+  bool hasSeconds = placeNoteHeads();
+  placeAccidentals();
+
+  // Notes start after the key signature
+  int numAccidentalsInKey = getNumAccidentals(keySignature);
+  double keySigWidth =
+      numAccidentalsInKey * dim.accidentalSpacing() +
+      (numAccidentalsInKey > 0 ? dim.keySignaturePadding() : 0);
+  double baseX =
+      dim.leftMargin() + dim.clefWidth() + keySigWidth + dim.clefPadding();
+
+  // With seconds the note heads straddle the stem line, touching it from
+  // either side
+  double noteWidth = dim.noteWidth();
+  double normalX = hasSeconds ? baseX - noteWidth / 2 : baseX;
+  double accidentalX = normalX - dim.accidentalOffset();
+  layoutLedgerLines(normalX);
+  for (size_t i = 0; i < numNotes; i++) {
+    addNote(spellings[i], reversed[i] ? normalX + noteWidth : normalX,
+            accidentalX - accidentalColumns[i] * dim.accidentalColumnWidth());
+  }
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layoutLedgerLines(double normalX) {
+  // Outermost ledger line each note head column needs above the treble
+  // staff, below the bass staff and at middle C
+  int highest[2] = {kTrebleTopLineStep, kTrebleTopLineStep};
+  int lowest[2] = {kBassBottomLineStep, kBassBottomLineStep};
+  bool middleC[2] = {false, false};
+  for (size_t i = 0; i < numNotes; i++) {
+    const NoteSpelling &spelling = spellings[i];
+    int column = reversed[i] ? 1 : 0;
+    int outermost = 2 * spelling.ledgerLines;
+    if (spelling.staffStep > 0)
+      highest[column] =
+          std::max(highest[column], kTrebleTopLineStep + outermost);
+    else if (spelling.staffStep < 0)
+      lowest[column] =
+          std::min(lowest[column], kBassBottomLineStep - outermost);
+    else
+      middleC[column] = true;
+  }
+
+  // One line per step, under every column that needs it
+  double noteWidth = dim.noteWidth();
+  auto addLedgerLine = [&](int step, bool normal, bool reversed) {
+    if (!normal && !reversed)
+      return;
+    DisplayItem line =
+        makeSymbol(DisplayItemType::kLedgerLine,
+                   normal ? normalX : normalX + noteWidth, getStaffStepY(step));
+    if (normal && reversed)
+      line.right += noteWidth;
+    items.push_back(line);
+  };
+  addLedgerLine(0, middleC[0], middleC[1]);
+  for (int step = kTrebleTopLineStep + 2;
+       step <= std::max(highest[0], highest[1]); step += 2)
+    addLedgerLine(step, highest[0] >= step, highest[1] >= step);
+  for (int step = kBassBottomLineStep - 2;
+       step >= std::min(lowest[0], lowest[1]); step -= 2)
+    addLedgerLine(step, lowest[0] <= step, lowest[1] <= step);
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::layoutChordSymbol() {
+  if (!chord.isValid())
+    return;
+
+  // Root and bass are spelled with flats in flat keys
+  char symbol[32];
+  formatChordSymbol(chord, usesFlats(keySignature), symbol, sizeof(symbol));
+
+  // Top left corner, above the treble clef
+  double fontSize = dim.staffLineHeight() * 1.6;
+  double left = dim.leftMargin();
+  double top = dim.staffLineHeight() * 0.5;
+  addText(symbol, left, top, dim.width - dim.rightMargin(),
+          top + fontSize * 1.25, fontSize, TextAlign::kLeft, kBlack, true);
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::addLine(double x1, double y1, double x2, double y2,
+                             double lineWidth, LayoutColor color) {
+  DisplayItem item;
+  item.type = DisplayItemType::kLine;
+  item.color = color;
+  item.left = x1;
+  item.top = y1;
+  item.right = x2;
+  item.bottom = y2;
+  item.lineWidth = lineWidth;
+  items.push_back(item);
+}
+
+//------------------------------------------------------------------------
+DisplayItem NotationLayout::makeSymbol(DisplayItemType type, double x,
+                                       double y) const {
+  DisplayItem item;
+  item.type = type;
+  item.color = kBlack;
+  switch (type) {
+  case DisplayItemType::kNoteHead:
+    item.left = x - dim.noteWidth() / 2;
+    item.top = y - dim.noteHeight() / 2;
+    item.right = x + dim.noteWidth() / 2;
+    item.bottom = y + dim.noteHeight() / 2;
+    item.lineWidth = 1.2;
+    break;
+  case DisplayItemType::kLedgerLine:
+    item.left = x - dim.ledgerLineWidth() / 2;
+    item.right = x + dim.ledgerLineWidth() / 2;
+    item.top = item.bottom = y;
+    item.lineWidth = 2.0;
+    break;
+  default: // Accidentals
+    item.left = item.right = x;
+    item.top = item.bottom = y;
+    item.lineWidth = 2.0;
+    item.size = dim.symbolBaseSize();
+    break;
+  }
+  return item;
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::addText(const char *string, double left, double top,
+                             double right, double bottom, double fontSize,
+                             TextAlign align, LayoutColor color, bool bold) {
+  DisplayItem item;
+  item.type = DisplayItemType::kText;
+  item.align = align;
+  item.bold = bold;
+  item.color = color;
+  item.left = left;
+  item.top = top;
+  item.right = right;
+  item.bottom = bottom;
+  item.size = fontSize;
+  item.textOffset = static_cast<uint32_t>(text.size());
+  text.append(string);
+  text.push_back('\0');
+  items.push_back(item);
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::addNote(const NoteSpelling &spelling, double x,
+                             double accidentalX) {
+  // Ledger lines are laid out for the whole chord beforehand
+  double y = getStaffStepY(spelling.staffStep);
+  switch (spelling.accidental) {
+  case kSharpAccidental:
+    items.push_back(makeSymbol(DisplayItemType::kSharp, accidentalX, y));
+    break;
+  case kFlatAccidental:
+    items.push_back(makeSymbol(DisplayItemType::kFlat, accidentalX, y));
+    break;
+  case kNaturalAccidental:
+    items.push_back(makeSymbol(DisplayItemType::kNatural, accidentalX, y));
+    break;
+  default:
+    break;
+  }
+
+  items.push_back(makeSymbol(DisplayItemType::kNoteHead, x, y));
+}
+
+//------------------------------------------------------------------------
+double NotationLayout::getStaffStepY(int staffStep) const {
+  // Middle C sits halfway between the staves; each step is half a space
+  return dim.height / 2.0 - staffStep * (dim.staffLineHeight() / 2.0);
+}
+
+//------------------------------------------------------------------------
+bool NotationLayout::placeNoteHeads() {
+  // From the bottom up, a note a second (or unison) above a note on the
+  // normal side of the stem goes on the other side; anything else goes
+  // on the normal side. Clusters alternate, starting with their lowest.
+  bool hasSeconds = false;
+  for (size_t i = 0; i < numNotes; i++) {
+    reversed[i] = i > 0 && !reversed[i - 1] &&
+                  spellings[i].staffStep - spellings[i - 1].staffStep <= 1;
+    hasSeconds |= reversed[i];
+  }
+  return hasSeconds;
+}
+
+//------------------------------------------------------------------------
+void NotationLayout::placeAccidentals() {
+  // Accidentals need a seventh between them to share a column
+  const int kClearanceSteps = 5;
+  const int kNone = 1000;
+
+  // Engraving order: highest, lowest, second highest, second lowest... each
+  // into the first column with room. Every accidental placed so far is then
+  // either above (placed from the top) or below (from the bottom) this one,
+  // so checking a column is two comparisons.
+  size_t numColumns = 0;
+  size_t top = numNotes;
+  size_t bottom = 0;
+  bool fromTop = true;
+  while (true) {
+    // Next note with an accidental from the chosen end
+    size_t note = numNotes;
+    if (fromTop) {
+      while (top > bottom && spellings[top - 1].accidental == kNoAccidental)
+        top--;
+      if (top > bottom)
+        note = --top;
+    } else {
+      while (bottom < top && spellings[bottom].accidental == kNoAccidental)
+        bottom++;
+      if (bottom < top)
+        note = bottom++;
+    }
+    if (note == numNotes)
+      break; // The scan met the other end
+
+    int step = spellings[note].staffStep;
+    size_t column = 0;
+    for (; column < numColumns; column++) {
+      const AccidentalColumn &c = columns[column];
+      if (c.lowestFromTop - step > kClearanceSteps &&
+          step - c.highestFromBottom > kClearanceSteps)
+        break;
+    }
+    if (column == numColumns)
+      columns[numColumns++] = {kNone, -kNone};
+
+    if (fromTop)
+      columns[column].lowestFromTop = step;
+    else
+      columns[column].highestFromBottom = step;
+    accidentalColumns[note] = static_cast<uint8_t>(column);
+    fromTop = !fromTop;
+  }
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,243 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "chord_table.h"
+#include "key_signature.h"
+#include "note_spelling.h"
+#include "note_state.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// Display list
+//------------------------------------------------------------------------
+struct LayoutRect {
+  double left = 0.0;
+  double top = 0.0;
+  double right = 0.0;
+  double bottom = 0.0;
+
+  bool isEmpty() const { return right <= left || bottom <= top; }
+  bool overlaps(const LayoutRect &other) const {
+    return left < other.right && other.left < right && top < other.bottom &&
+           other.top < bottom;
+  }
+  LayoutRect &unite(const LayoutRect &other) {
+    if (other.isEmpty())
+      return *this;
+    if (isEmpty())
+      return *this = other;
+    left = std::min(left, other.left);
+    top = std::min(top, other.top);
+    right = std::max(right, other.right);
+    bottom = std::max(bottom, other.bottom);
+    return *this;
+  }
+};
+
+struct LayoutColor {
+  uint8_t red = 0;
+  uint8_t green = 0;
+  uint8_t blue = 0;
+  uint8_t alpha = 255;
+};
+
+enum class DisplayItemType : uint8_t {
+  kFilledRect, // Bounds filled with color
+  kLine,       // (left, top) to (right, bottom), lineWidth wide
+  kNoteHead,   // Filled ellipse in the bounds
+  kSharp,      // Glyphs drawn at (left, top), size = symbol size
+  kFlat,
+  kNatural,
+  kLedgerLine, // Like kLine, always horizontal and ledger wide
+  kText        // getText(item) drawn in the bounds at fontSize = size
+};
+
+enum class TextAlign : uint8_t { kCenter, kLeft };
+
+struct DisplayItem {
+  DisplayItemType type = DisplayItemType::kLine;
+  TextAlign align = TextAlign::kCenter;
+  bool bold = false;
+  LayoutColor color;
+  double left = 0.0; // Bounds, line end points or glyph position
+  double top = 0.0;
+  double right = 0.0;
+  double bottom = 0.0;
+  double lineWidth = 0.0;
+  double size = 0.0;
+  uint32_t textOffset = 0; // Into the layout's text
+};
+
+//------------------------------------------------------------------------
+// NotationLayout - Grand staff layout, independent of any drawing API
+//
+// Turns the note set, key and view size into a flat list of lines, glyphs
+// and text in view coordinates (origin at the view's top left). Drawing is
+// then a straight walk over getItems(). Item and text storage is reused
+// from one layout to the next.
+//
+// The first getNumStaticItems() items (background, staff, clefs, note
+// names, key signature) depend only on the key and view size; the notes
+// and chord symbol follow them. The area each part covers is kept so a
+// view can repaint just what changed.
+//
+// Scratch space is inline and sized for all 128 notes, and the item and
+// text storage is reserved up front, so laying out again allocates
+// nothing unless a chord needs more items than any before it.
+//------------------------------------------------------------------------
+class NotationLayout {
+public:
+  NotationLayout();
+
+  void layout(const NoteMask &notes, KeySignature key, double width,
+              double height);
+
+  const std::vector<DisplayItem> &getItems() const { return items; }
+  size_t getNumStaticItems() const { return numStaticItems; }
+  const char *getText(const DisplayItem &item) const {
+    return text.c_str() + item.textOffset;
+  }
+
+  // Chord named by the last layout
+  const ChordName &getChord() const { return chord; }
+
+  double getWidth() const { return dim.width; }
+  double getHeight() const { return dim.height; }
+
+  // Area covered by the notes and chord symbol, and by the key signature
+  const LayoutRect &getNoteBounds() const { return noteBounds; }
+  const LayoutRect &getKeySignatureBounds() const {
+    return keySignatureBounds;
+  }
+
+  // Everything the item paints, line widths included
+  static LayoutRect getItemBounds(const DisplayItem &item);
+
+  // A note head, accidental or ledger line centered (note head, ledger
+  // line) or anchored (accidentals) at x, y, sized for the last layout.
+  // All symbols of one type in a layout differ only in position.
+  DisplayItem makeSymbol(DisplayItemType type, double x, double y) const;
+
+  // Proportional sizing helper - all dimensions based on view size
+  struct Dimensions {
+    double width;
+    double height;
+
+    // Intuitive proportional constants based on semantic layout
+    static constexpr double STAFF_LINE_HEIGHT_RATIO =
+        0.05; // 5% of window height per staff line space
+    static constexpr double GRAND_STAFF_GAP_RATIO =
+        0.1; // 15% gap between staves
+
+    // Layout margins and spacing
+    static constexpr double LEFT_MARGIN_RATIO = 0.025; // 2.5% left margin
+    static constexpr double RIGHT_MARGIN_RATIO = 0.05; // 5% right margin
+    static constexpr double CLEF_WIDTH_RATIO =
+        0.1; // 10% of width for the clef symbol area
+    static constexpr double CLEF_PADDING_RATIO =
+        0.15; // 15% padding between clef and key signature
+    // Spacing and positioning
+    static constexpr double ACCIDENTAL_SPACING_RATIO =
+        0.015; // 1.5% between key sig accidentals
+    static constexpr double NOTE_GROUP_SPACING_RATIO =
+        0.05; // 5% between chord groups
+    static constexpr double LEDGER_LINE_WIDTH_RATIO =
+        0.04; // 4% ledger line width
+    static constexpr double ACCIDENTAL_OFFSET_RATIO =
+        0.04; // 4% offset for accidentals from notes
+    static constexpr double KEY_SIGNATURE_PADDING_RATIO =
+        0.02; // 2% padding around key signature
+
+    // Symbol drawing proportions (relative to smaller dimension for
+    // consistency)
+    static constexpr double SYMBOL_BASE_SIZE_RATIO =
+        0.03; // 3% of smaller dimension
+
+    // Calculate actual dimensions
+    double staffLineHeight() const { return height * STAFF_LINE_HEIGHT_RATIO; }
+    double grandStaffGap() const { return staffLineHeight() * 2.0; }
+    double noteWidth() const { return staffLineHeight() * 1.3; }
+    double noteHeight() const { return staffLineHeight() * 0.94; }
+    double clefWidth() const { return width * CLEF_WIDTH_RATIO; }
+    double clefPadding() const { return width * CLEF_PADDING_RATIO; }
+    double leftMargin() const { return width * LEFT_MARGIN_RATIO; }
+    double rightMargin() const { return width * RIGHT_MARGIN_RATIO; }
+    double clefFontSize() const { return staffLineHeight() * 6.0; }
+    double accidentalSpacing() const {
+      return width * ACCIDENTAL_SPACING_RATIO;
+    }
+    double noteGroupSpacing() const { return width * NOTE_GROUP_SPACING_RATIO; }
+    double ledgerLineWidth() const { return noteWidth() * 1.5; }
+    double accidentalOffset() const { return noteWidth() * 2.0; }
+    double accidentalColumnWidth() const { return symbolBaseSize() * 1.25; }
+    double keySignaturePadding() const {
+      return width * KEY_SIGNATURE_PADDING_RATIO;
+    }
+
+    // Symbol drawing proportions
+    double symbolBaseSize() const {
+      return std::min(width, height) * SYMBOL_BASE_SIZE_RATIO;
+    }
+  };
+
+private:
+  void layoutStaff();
+  void layoutNoteNames();
+  void layoutKeySignature();
+  void layoutNotes(const NoteMask &notes);
+  void layoutChordSymbol();
+
+  void addLine(double x1, double y1, double x2, double y2, double lineWidth,
+               LayoutColor color = LayoutColor());
+  void addText(const char *string, double left, double top, double right,
+               double bottom, double fontSize, TextAlign align,
+               LayoutColor color, bool bold = false);
+  void addNote(const NoteSpelling &spelling, double x, double accidentalX);
+  double getStaffStepY(int staffStep) const;
+  LayoutRect getBounds(size_t first, size_t last) const;
+
+  // Chord engraving, one sweep each over the notes in staff step order
+  bool placeNoteHeads();
+  void placeAccidentals();
+  void layoutLedgerLines(double normalX);
+
+  Dimensions dim = {0.0, 0.0};
+  KeySignature keySignature = kCMajor;
+  ChordName chord;
+
+  std::vector<DisplayItem> items;
+  size_t numStaticItems = 0;
+  LayoutRect noteBounds;
+  LayoutRect keySignatureBounds;
+  std::string text; // Nul-terminated strings, one after the other
+
+  // Room for the staff, key signature and a chord of a dozen notes
+  static constexpr size_t kReservedItems = 256;
+  static constexpr size_t kReservedText = 256;
+
+  // Scratch space for layoutNotes(), lowest note first
+  std::array<NoteSpelling, kNumMidiNotes> spellings;
+  std::array<bool, kNumMidiNotes> reversed; // Right of the stem line
+  std::array<uint8_t, kNumMidiNotes> accidentalColumns; // 0 nearest
+  size_t numNotes = 0;
+
+  // Accidentals a column holds, placed from the outside in: the lowest
+  // one placed from the top and the highest one placed from the bottom
+  struct AccidentalColumn {
+    int lowestFromTop;
+    int highestFromBottom;
+  };
+  std::array<AccidentalColumn, kNumMidiNotes> columns;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,305 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#include "note_processor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Ursulean {
+//------------------------------------------------------------------------
+// NoteProcessor
+//------------------------------------------------------------------------
+void NoteProcessor::beginBlock(int32_t numSamples, bool hasContinuousTime,
+                               int64_t continuousTime, ControllerOutput *output,
+                               const MusicalTime *musicalTime) {
+  // Prefer the host's clocks; fall back to counting processed samples
+  blockStartSample = hasContinuousTime ? continuousTime : nextBlockStartSample;
+  nextBlockStartSample = blockStartSample + numSamples;
+
+  blockOutput = output;
+  blockNumSamples = numSamples;
+  blockStartNotes = activeNotes.mask();
+  blockOutputPoints = 0;
+  lastOffset = 0;
+  hasPendingTransition = false;
+  blockTransitions = 0;
+
+  //--- Pick up any state restored since the last block
+  applyPendingState();
+
+  // Nothing is tracked while bypassed; the display clears
+  blockBypassed = isBypassed();
+  if (blockBypassed)
+    activeNotes.assign(NoteMask(), blockStartSample);
+
+  // Detection starts from scratch whenever it is switched on, and nothing
+  // it found before counts
+  bool wasAutoKey = blockAutoKey;
+  blockAutoKey = isAutoKey() && !blockBypassed;
+  if (blockAutoKey && !wasAutoKey) {
+    hasPendingKeyReset = true;
+    appliedDetectedKeyVersion =
+        detectedKeyVersion.load(std::memory_order_acquire);
+  }
+  if (blockAutoKey && hasPendingKeyReset) {
+    NoteEvent reset;
+    reset.sampleTime = blockStartSample;
+    reset.type = NoteEvent::kReset;
+    hasPendingKeyReset = !noteEventQueue.push(reset);
+  }
+
+  // A jump is any start where the previous block didn't end. It goes out
+  // ahead of the block's note changes so they land after it.
+  hasMusicalTime = musicalTime != nullptr;
+  if (hasMusicalTime) {
+    bool jumped =
+        !hasPreviousTime || musicalTime->isPlaying != blockTime.isPlaying ||
+        std::abs(musicalTime->position - expectedPosition) > kLocateTolerance;
+    hasPendingLocate = hasPendingLocate || jumped;
+    if (jumped)
+      numJumps++;
+
+    blockTime = *musicalTime;
+    expectedPosition = blockTime.position;
+    if (blockTime.isPlaying)
+      expectedPosition += numSamples * blockTime.tempo / (60.0 * sampleRate);
+
+    if (hasPendingLocate && blockOutput)
+      blockOutputPoints += sendLocate();
+  }
+  hasPreviousTime = hasMusicalTime;
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::addNote(const MidiNoteInput &note) {
+  // Only the audio-thread NoteState (and with auto key, the note event
+  // queue) is touched per event. The output sees one net change per
+  // distinct sample offset, and the published snapshot one per block.
+  if (blockBypassed || note.pitch < 0 || note.pitch >= kNumMidiNotes)
+    return;
+
+  // Events arrive sorted by offset. Once the offset moves on, everything at
+  // the previous offset is one transition: send it stamped there.
+  int32_t offset =
+      std::max(0, std::min(note.sampleOffset, blockNumSamples - 1));
+  if (hasPendingTransition && offset != lastOffset)
+    flushTransition(false);
+  lastOffset = offset;
+  hasPendingTransition = true;
+
+  int64_t sampleTime = blockStartSample + offset;
+  if (note.isNoteOn && note.velocity > 0) {
+    int velocity = static_cast<int>(note.velocity * 127.f + 0.5f);
+    activeNotes.noteOn(
+        note.pitch, static_cast<uint8_t>(std::max(1, std::min(velocity, 127))),
+        static_cast<uint8_t>(note.channel & 0xF), sampleTime);
+  } else {
+    activeNotes.noteOff(note.pitch, sampleTime); // Velocity 0 means note off
+  }
+
+  if (blockAutoKey) {
+    NoteEvent event;
+    event.sampleTime = sampleTime;
+    event.pitch = static_cast<uint8_t>(note.pitch);
+    if (note.isNoteOn && note.velocity > 0) {
+      event.velocity = note.velocity;
+      event.type = NoteEvent::kNoteOn;
+    } else {
+      event.type = NoteEvent::kNoteOff;
+    }
+    pushNoteEvent(event);
+  }
+}
+
+//------------------------------------------------------------------------
+uint32_t NoteProcessor::endBlock() {
+  // Last transition of the block. It also carries whatever the controller
+  // still hasn't seen (restored state, or a block where the host gave us no
+  // output queue), so that goes out at offset 0 only in a block without
+  // transitions and never behind a point already in the queues.
+  flushTransition(true);
+
+  if (blockAutoKey) {
+    noteEventTime.store(blockStartSample + blockNumSamples,
+                        std::memory_order_release);
+    blockOutputPoints += sendDetectedKey();
+  }
+
+  // Make the net change visible to other threads (once per block)
+  if (activeNotes.mask() != blockStartNotes)
+    publishedNotes.publish(activeNotes.mask());
+
+  lastBlockOutputPoints.store(blockOutputPoints, std::memory_order_relaxed);
+  totalOutputPoints.store(
+      totalOutputPoints.load(std::memory_order_relaxed) + blockOutputPoints,
+      std::memory_order_relaxed);
+  totalBlocks.store(totalBlocks.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+
+  blockOutput = nullptr;
+  return blockOutputPoints;
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::pushNoteEvent(const NoteEvent &event) {
+  // Whatever comes before the reset would be forgotten anyway
+  if (!hasPendingKeyReset)
+    noteEventQueue.push(event); // Dropped if the detection falls behind
+}
+
+//------------------------------------------------------------------------
+uint32_t NoteProcessor::sendDetectedKey() {
+  // Scoring happens on the key detection thread; a new key is taken up
+  // here, at the end of the block it arrived in
+  uint32_t version = detectedKeyVersion.load(std::memory_order_acquire);
+  if (version != appliedDetectedKeyVersion) {
+    appliedDetectedKeyVersion = version;
+    currentKeySignature = detectedKey.load(std::memory_order_relaxed);
+    keySignature.store(currentKeySignature, std::memory_order_relaxed);
+  }
+
+  if (!blockOutput || currentKeySignature == hostKeySignature)
+    return 0;
+  if (!blockOutput->sendKeySignature(currentKeySignature,
+                                     std::max(0, blockNumSamples - 1)))
+    return 0;
+  hostKeySignature = currentKeySignature;
+  return 1;
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::reset() {
+  hasPreviousTime = false; // Whatever comes next is a jump
+  blockAutoKey = false;    // Key detection starts over
+  activeNotes.clear();
+  publishedNotes.publish(activeNotes.mask());
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::restoreNotes(const NoteMask &notes) {
+  pendingState.publish(notes);
+  pendingStateVersion.fetch_add(1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::setKeySignature(KeySignature key) {
+  pendingKeySignature.store(key, std::memory_order_relaxed);
+  keySignature.store(key, std::memory_order_relaxed);
+  pendingKeyVersion.fetch_add(1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::setDetectedKey(KeySignature key) {
+  detectedKey.store(key, std::memory_order_relaxed);
+  detectedKeyVersion.fetch_add(1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------
+NoteProcessor::OutputPointStats NoteProcessor::getOutputPointStats() const {
+  OutputPointStats stats;
+  stats.lastBlockPoints = lastBlockOutputPoints.load(std::memory_order_relaxed);
+  stats.totalPoints = totalOutputPoints.load(std::memory_order_relaxed);
+  stats.totalBlocks = totalBlocks.load(std::memory_order_relaxed);
+  return stats;
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::flushTransition(bool isLastInBlock) {
+  if (!blockOutput || activeNotes.mask() == hostNotes)
+    return;
+
+  // A block with more transitions than that still ends on its last one
+  if (isLastInBlock || blockTransitions + 1 < kMaxBlockTransitions)
+    blockOutputPoints += sendTransition(lastOffset);
+  blockOutputPoints += sendNoteMaskChanges(lastOffset);
+}
+
+//------------------------------------------------------------------------
+void NoteProcessor::applyPendingState() {
+  uint32_t keyVersion = pendingKeyVersion.load(std::memory_order_acquire);
+  if (keyVersion != appliedKeyVersion) {
+    appliedKeyVersion = keyVersion;
+    currentKeySignature = pendingKeySignature.load(std::memory_order_relaxed);
+    hostKeySignature = currentKeySignature;
+  }
+
+  uint32_t version = pendingStateVersion.load(std::memory_order_acquire);
+  if (version == appliedStateVersion)
+    return;
+  appliedStateVersion = version;
+
+  activeNotes.assign(pendingState.read(), blockStartSample);
+}
+
+//------------------------------------------------------------------------
+uint32_t NoteProcessor::sendNoteMaskChanges(int32_t sampleOffset) {
+  // Only the packed 16-note words that differ from what the host last
+  // accepted go out. A word is marked as sent only once the host has taken
+  // the point, so a full or missing queue is simply retried next block, and
+  // notes that came and went at the same offset cost nothing.
+  const NoteMask &notes = activeNotes.mask();
+  NoteMask changed = notes ^ hostNotes;
+  uint32_t numPoints = 0;
+
+  for (int w = 0; w < kNumNoteMaskWords; w++) {
+    if (getNoteMaskWord(changed, w) == 0)
+      continue;
+
+    uint16_t word = getNoteMaskWord(notes, w);
+    if (blockOutput->sendNoteMaskWord(w, word, sampleOffset)) {
+      setNoteMaskWord(hostNotes, w, word);
+      numPoints++;
+    }
+  }
+
+  return numPoints;
+}
+
+//------------------------------------------------------------------------
+uint32_t NoteProcessor::sendTransition(int32_t sampleOffset) {
+  // Transitions are not retried: a lost one only leaves its chord out of
+  // the controller's history and timeline
+  NoteTransition transition;
+  transition.notes = activeNotes.mask();
+  transition.time = (blockStartSample + sampleOffset) / sampleRate;
+  transition.key = currentKeySignature;
+  transition.jumps = numJumps;
+  transition.sequence = transitionSequence++;
+  transition.isPlaying = hasMusicalTime && blockTime.isPlaying;
+  blockTransitions++;
+
+  // Only changes while playing belong on the timeline
+  if (transition.isPlaying) {
+    transition.position = blockTime.position +
+                          sampleOffset * blockTime.tempo / (60.0 * sampleRate);
+    transition.bar = blockTime.bar;
+    transition.tempo = blockTime.tempo;
+    transition.beatsPerBar = blockTime.beatsPerBar;
+    transition.beatUnit = blockTime.beatUnit;
+    if (blockTime.quartersPerBar > 0.0) {
+      transition.bar += static_cast<int32_t>(
+          std::floor((transition.position - blockTime.barStart) /
+                     blockTime.quartersPerBar));
+    }
+  }
+
+  if (!blockOutput->sendTransition(transition, sampleOffset))
+    return 0;
+  uint32_t numParts = 0;
+  for (int part = 0; part < kNumTransitionParts; part++)
+    numParts += isTransitionPartSent(transition, part) ? 1 : 0;
+  return numParts;
+}
+
+//------------------------------------------------------------------------
+uint32_t NoteProcessor::sendLocate() {
+  if (!blockOutput->sendLocate(blockTime.position, 0))
+    return 0; // Retried next block
+  hasPendingLocate = false;
+  return 1;
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
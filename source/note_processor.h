@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "lock_free.h"
+#include "note_state.h"
+#include "note_transport.h"
+#include <atomic>
+#include <cstdint>
+
+namespace Ursulean {
+
+// Note change handed from the audio thread to the key detection thread
+struct NoteEvent {
+  enum Type : uint8_t { kNoteOn, kNoteOff, kReset };
+  int64_t sampleTime = 0; // Continuous time, samples
+  float velocity = 0.f;   // 0..1
+  uint8_t pitch = 0;
+  Type type = kNoteOn; // kReset: forget everything before this event
+};
+
+// Note on/off as delivered by the host, already stripped of plugin API types
+struct MidiNoteInput {
+  int32_t sampleOffset = 0; // Offset into the current block
+  int pitch = 0;            // MIDI note, out of range values are ignored
+  float velocity = 0.f;     // 0..1, a note on with 0 counts as note off
+  int channel = 0;
+  bool isNoteOn = false;
+};
+
+// Host transport position at the start of a block, in quarter notes
+struct MusicalTime {
+  double position = 0.0;       // From the project start
+  double tempo = 120.0;        // Quarter notes per minute
+  double barStart = 0.0;       // Position of the bar containing position
+  double quartersPerBar = 4.0; // From the time signature
+  int32_t beatsPerBar = 4;     // The time signature
+  int32_t beatUnit = 4;
+  int32_t bar = 0;             // Index of that bar, from 0
+  bool isPlaying = false;
+};
+
+// Destination for values sent on to the controller (the host's output
+// parameter queue in the plugin). Returns false if the point wasn't
+// accepted, in which case it is offered again on the next block.
+class ControllerOutput {
+public:
+  virtual ~ControllerOutput() {}
+  virtual bool sendNoteMaskWord(int wordIndex, uint16_t word,
+                                int32_t sampleOffset) = 0;
+  virtual bool sendKeySignature(KeySignature key, int32_t sampleOffset) = 0;
+  // The note change sent at the same offset, complete in itself. True if
+  // every part of it was accepted.
+  virtual bool sendTransition(const NoteTransition &transition,
+                              int32_t sampleOffset) = 0;
+  // The transport jumped (locate, loop, start or stop)
+  virtual bool sendLocate(double quarters, int32_t sampleOffset) = 0;
+};
+
+//------------------------------------------------------------------------
+// NoteProcessor - Audio-thread note tracking, independent of the plugin API
+//
+// NotationChordHelperProcessor translates host events and parameter queues
+// into calls on this class, which lets the same code run in benchmarks and
+// tools without a host. A block is beginBlock(), any number of addNote()
+// calls in offset order, then endBlock().
+//------------------------------------------------------------------------
+class NoteProcessor {
+public:
+  //--- Audio thread ---------------------------------------------------------
+  // hasContinuousTime is false when the host didn't provide a clock, in
+  // which case processed samples are counted instead. Without musicalTime
+  // no song positions are sent.
+  void beginBlock(int32_t numSamples, bool hasContinuousTime,
+                  int64_t continuousTime, ControllerOutput *output,
+                  const MusicalTime *musicalTime = nullptr);
+  void addNote(const MidiNoteInput &note);
+  // Returns the number of output points the block emitted
+  uint32_t endBlock();
+
+  void setSampleRate(double rate) { sampleRate = rate; }
+
+  // Deactivation; must not overlap a block
+  void reset();
+
+  //--- Any thread -----------------------------------------------------------
+  void setBypassed(bool state) {
+    bypassed.store(state, std::memory_order_relaxed);
+  }
+  bool isBypassed() const { return bypassed.load(std::memory_order_relaxed); }
+
+  // Follow the key of the incoming notes and send it out as the key
+  // signature. The notes go to a key detection thread through
+  // popNoteEvent(), which hands its verdict back with setDetectedKey().
+  void setAutoKey(bool state) {
+    autoKey.store(state, std::memory_order_relaxed);
+  }
+  bool isAutoKey() const { return autoKey.load(std::memory_order_relaxed); }
+
+  // Replace the sounding notes from another thread; applied at the start of
+  // the next block
+  void restoreNotes(const NoteMask &notes);
+
+  // Set from the host (automation or restored state), so also what the
+  // controller has already been told; applied at the start of the next
+  // block. Reads give the key as last set or detected.
+  void setKeySignature(KeySignature key);
+  KeySignature getKeySignature() const {
+    return keySignature.load(std::memory_order_relaxed);
+  }
+
+  NoteMask getActiveNoteMask() const { return publishedNotes.read(); }
+
+  // Output parameter points emitted so far, for profiling the
+  // processor -> controller traffic
+  struct OutputPointStats {
+    uint32_t lastBlockPoints = 0; // Points emitted by the most recent block
+    uint64_t totalPoints = 0;     // Points emitted since construction
+    uint64_t totalBlocks = 0;     // Blocks processed since construction
+  };
+  OutputPointStats getOutputPointStats() const;
+
+  //--- Key detection thread (one consumer) -----------------------------------
+  // Note changes while auto key is on, in order. Dropped while the queue is
+  // full, which only makes the detection a little less informed.
+  bool popNoteEvent(NoteEvent &event) { return noteEventQueue.pop(event); }
+  // Continuous time the audio thread has reached with auto key on
+  int64_t getNoteEventTime() const {
+    return noteEventTime.load(std::memory_order_acquire);
+  }
+  // Picked up by the next block with auto key on
+  void setDetectedKey(KeySignature key);
+
+private:
+  void flushTransition(bool isLastInBlock);
+  void applyPendingState();
+  uint32_t sendNoteMaskChanges(int32_t sampleOffset);
+  uint32_t sendTransition(int32_t sampleOffset);
+  uint32_t sendLocate();
+  void pushNoteEvent(const NoteEvent &event);
+  uint32_t sendDetectedKey();
+
+  // Audio thread only - never touched while a block may be running
+  NoteState activeNotes;            // Currently pressed MIDI notes (0-127)
+  int64_t blockStartSample = 0;     // Continuous time of this block, samples
+  int64_t nextBlockStartSample = 0; // Fallback clock when the host has none
+  KeySignature currentKeySignature = kCMajor;
+  KeySignature hostKeySignature = kCMajor; // As last accepted by the host
+  NoteMask hostNotes; // Notes as last accepted by the host's output queue
+  double sampleRate = 44100.0;
+
+  // Transition and song position state, also audio thread only
+  static constexpr double kLocateTolerance = 1.0 / 64.0; // Quarter notes
+  // Keeps the sequence numbers of one block's transitions apart (see
+  // NoteTransitionAssembler)
+  static constexpr uint32_t kMaxBlockTransitions =
+      kTransitionSequenceCycle / 2;
+  bool hasMusicalTime = false;      // This block has a musical position
+  bool hasPreviousTime = false;     // So had the previous one
+  MusicalTime blockTime;            // At the start of this block
+  double expectedPosition = 0.0;    // Where this block should have started
+  bool hasPendingLocate = false;    // Jump not yet accepted by the host
+  uint32_t numJumps = 0;            // Both counters wrap around
+  uint32_t transitionSequence = 0;
+
+  // Per-block state between beginBlock() and endBlock()
+  ControllerOutput *blockOutput = nullptr;
+  NoteMask blockStartNotes;
+  int32_t blockNumSamples = 0;
+  int32_t lastOffset = 0;
+  bool hasPendingTransition = false;
+  uint32_t blockTransitions = 0;
+  bool blockBypassed = false;
+  bool blockAutoKey = false;
+  bool hasPendingKeyReset = false; // No note events until it is queued
+  uint32_t blockOutputPoints = 0;
+
+  std::atomic<bool> bypassed{false};
+  std::atomic<bool> autoKey{false};
+  std::atomic<KeySignature> keySignature{kCMajor};
+
+  // Audio thread -> other threads
+  SnapshotPublisher<NoteMask> publishedNotes;
+  SpscQueue<NoteEvent, 1024> noteEventQueue;
+  std::atomic<int64_t> noteEventTime{0};
+  std::atomic<uint32_t> lastBlockOutputPoints{0};
+  std::atomic<uint64_t> totalOutputPoints{0};
+  std::atomic<uint64_t> totalBlocks{0};
+
+  // restoreNotes() and setKeySignature() -> audio thread
+  SnapshotPublisher<NoteMask> pendingState;
+  std::atomic<uint32_t> pendingStateVersion{0};
+  uint32_t appliedStateVersion = 0;
+  std::atomic<KeySignature> pendingKeySignature{kCMajor};
+  std::atomic<uint32_t> pendingKeyVersion{0};
+  uint32_t appliedKeyVersion = 0;
+
+  // setDetectedKey() -> audio thread
+  std::atomic<KeySignature> detectedKey{kCMajor};
+  std::atomic<uint32_t> detectedKeyVersion{0};
+  uint32_t appliedDetectedKeyVersion = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
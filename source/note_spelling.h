@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "note_state.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// NoteSpelling - How one MIDI note is written in one key
+//------------------------------------------------------------------------
+enum NoteAccidental : uint8_t {
+  kNoAccidental = 0, // As the key signature has it
+  kSharpAccidental,
+  kFlatAccidental,
+  kNaturalAccidental // Cancels the key signature
+};
+
+struct NoteSpelling {
+  int8_t staffStep = 0;    // Diatonic steps above middle C (C4 = 0)
+  uint8_t accidental = kNoAccidental;
+  uint8_t ledgerLines = 0; // Needed on the grand staff, counted outward
+};
+
+// Grand staff landmarks, in staff steps
+static constexpr int kTrebleTopLineStep = 10;   // F5
+static constexpr int kBassBottomLineStep = -10; // G2
+
+namespace NoteSpellingDetail {
+
+// Semitones above C of the letters C, D, E, F, G, A, B
+static constexpr int kLetterPitch[7] = {0, 2, 4, 5, 7, 9, 11};
+
+// Letters in the order the key signature adds them
+static constexpr int kSharpOrder[7] = {3, 0, 4, 1, 5, 2, 6}; // F C G D A E B
+static constexpr int kFlatOrder[7] = {6, 2, 5, 1, 4, 0, 3};  // B E A D G C F
+
+constexpr bool isFlatKey(int key) { return key >= kFMajor; }
+
+// Semitones the key signature moves the letter by (-1, 0 or +1)
+constexpr int keyAlteration(int key, int letter) {
+  int count = isFlatKey(key) ? key - kFMajor + 1 : key;
+  for (int i = 0; i < count; i++) {
+    if ((isFlatKey(key) ? kFlatOrder[i] : kSharpOrder[i]) == letter)
+      return isFlatKey(key) ? -1 : 1;
+  }
+  return 0;
+}
+
+constexpr int floorDiv12(int value) {
+  return value >= 0 ? value / 12 : -((11 - value) / 12);
+}
+
+constexpr NoteSpelling spell(int key, int midiNote) {
+  int pitchClass = midiNote % 12;
+  int letter = -1;
+  int alteration = 0;
+  uint8_t accidental = kNoAccidental;
+
+  // 1. A note of the key: written as the signature has it, no accidental
+  for (int l = 0; l < 7 && letter < 0; l++) {
+    int altered = kLetterPitch[l] + keyAlteration(key, l);
+    if ((altered + 12) % 12 == pitchClass) {
+      letter = l;
+      alteration = keyAlteration(key, l);
+    }
+  }
+
+  // 2. A letter the key alters, played plain: natural sign
+  for (int l = 0; l < 7 && letter < 0; l++) {
+    if (kLetterPitch[l] == pitchClass) {
+      letter = l;
+      accidental = kNaturalAccidental;
+    }
+  }
+
+  // 3. Anything else is a black key outside the key: sharpen the letter
+  // below in sharp keys (and C), flatten the letter above in flat keys
+  for (int l = 0; l < 7 && letter < 0; l++) {
+    if (!isFlatKey(key) && kLetterPitch[l] + 1 == pitchClass) {
+      letter = l;
+      alteration = 1;
+      accidental = kSharpAccidental;
+    } else if (isFlatKey(key) && kLetterPitch[l] - 1 == pitchClass) {
+      letter = l;
+      alteration = -1;
+      accidental = kFlatAccidental;
+    }
+  }
+
+  // The written letter's octave, e.g. B#3 sounds as C4 and Cb4 as B3
+  int writtenPitch = midiNote - alteration;
+  int octave = floorDiv12(writtenPitch);
+
+  NoteSpelling spelling;
+  int step = (octave - 5) * 7 + letter;
+  spelling.staffStep = static_cast<int8_t>(step);
+  spelling.accidental = accidental;
+  if (step == 0)
+    spelling.ledgerLines = 1; // Middle C
+  else if (step > kTrebleTopLineStep)
+    spelling.ledgerLines =
+        static_cast<uint8_t>((step - kTrebleTopLineStep) / 2);
+  else if (step < kBassBottomLineStep)
+    spelling.ledgerLines =
+        static_cast<uint8_t>((kBassBottomLineStep - step) / 2);
+  return spelling;
+}
+
+constexpr std::array<NoteSpelling, kNumMidiNotes> buildKey(int key) {
+  std::array<NoteSpelling, kNumMidiNotes> spellings{};
+  for (int note = 0; note < kNumMidiNotes; note++)
+    spellings[note] = spell(key, note);
+  return spellings;
+}
+
+template <size_t... Keys>
+constexpr std::array<std::array<NoteSpelling, kNumMidiNotes>, sizeof...(Keys)>
+buildTable(std::index_sequence<Keys...>) {
+  return {{buildKey(static_cast<int>(Keys))...}};
+}
+
+static constexpr std::array<std::array<NoteSpelling, kNumMidiNotes>,
+                            kNumKeySigs>
+    kSpellings = buildTable(std::make_index_sequence<kNumKeySigs>());
+
+} // namespace NoteSpellingDetail
+
+//------------------------------------------------------------------------
+// Note spelling lookup
+//
+// Staff step, accidental and ledger lines of every note in every key are
+// worked out at compile time, so laying out a note is one table read.
+// Foreign black keys are spelled with sharps in sharp keys and C major,
+// and with flats in flat keys.
+//------------------------------------------------------------------------
+inline const NoteSpelling &spellNote(KeySignature key, int midiNote) {
+  return NoteSpellingDetail::kSpellings[key][midiNote];
+}
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
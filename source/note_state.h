@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Ursulean {
+
+// Number of MIDI notes tracked (0-127)
+static constexpr int kNumMidiNotes = 128;
+
+//------------------------------------------------------------------------
+// Bit helpers - map to a single instruction on all supported compilers
+//------------------------------------------------------------------------
+inline int popCount64(uint64_t bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  return static_cast<int>(__popcnt64(bits));
+#elif defined(_MSC_VER)
+  bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+  bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+  bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+  return static_cast<int>((bits * 0x0101010101010101ull) >> 56);
+#else
+  return __builtin_popcountll(bits);
+#endif
+}
+
+// Index of the lowest set bit; bits must not be zero
+inline int lowestBit64(uint64_t bits) {
+#if defined(_MSC_VER)
+  unsigned long index = 0;
+  _BitScanForward64(&index, bits);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(bits);
+#endif
+}
+
+//------------------------------------------------------------------------
+// NoteMask - Set of MIDI notes stored as a 128-bit mask
+//------------------------------------------------------------------------
+struct NoteMask {
+  uint64_t words[2] = {0, 0}; // words[0] = notes 0-63, words[1] = 64-127
+
+  void set(int note) { words[note >> 6] |= (uint64_t)1 << (note & 63); }
+  void reset(int note) { words[note >> 6] &= ~((uint64_t)1 << (note & 63)); }
+  bool test(int note) const {
+    return (words[note >> 6] >> (note & 63)) & 1;
+  }
+  void clear() { words[0] = words[1] = 0; }
+
+  bool any() const { return (words[0] | words[1]) != 0; }
+  int count() const { return popCount64(words[0]) + popCount64(words[1]); }
+
+  // Call fn(note) for every note in the mask, lowest first
+  template <typename Fn> void forEach(Fn &&fn) const {
+    for (int w = 0; w < 2; w++) {
+      uint64_t bits = words[w];
+      while (bits) {
+        fn((w << 6) + lowestBit64(bits));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  bool operator==(const NoteMask &other) const {
+    return words[0] == other.words[0] && words[1] == other.words[1];
+  }
+  bool operator!=(const NoteMask &other) const { return !(*this == other); }
+
+  NoteMask operator^(const NoteMask &other) const {
+    return {{words[0] ^ other.words[0], words[1] ^ other.words[1]}};
+  }
+  NoteMask operator&(const NoteMask &other) const {
+    return {{words[0] & other.words[0], words[1] & other.words[1]}};
+  }
+  NoteMask operator|(const NoteMask &other) const {
+    return {{words[0] | other.words[0], words[1] | other.words[1]}};
+  }
+};
+
+//------------------------------------------------------------------------
+// NoteState - Sounding notes plus per-note attributes
+//
+// The mask answers "which notes" and the struct-of-arrays storage keeps the
+// attributes of each note in flat tables indexed by pitch, so nothing here
+// ever allocates and every operation is constant time.
+//------------------------------------------------------------------------
+class NoteState {
+public:
+  void noteOn(int pitch, uint8_t velocity, uint8_t channel,
+              int64_t onsetSample) {
+    sounding.set(pitch);
+    velocities[pitch] = velocity;
+    channels[pitch] = channel;
+    onsetSamples[pitch] = onsetSample;
+  }
+
+  void noteOff(int pitch, int64_t releaseSample) {
+    sounding.reset(pitch);
+    releaseSamples[pitch] = releaseSample;
+  }
+
+  // Replace the sounding notes, e.g. when restoring state. Notes that start
+  // or stop because of it are stamped with sampleTime.
+  void assign(const NoteMask &notes, int64_t sampleTime) {
+    (notes ^ sounding).forEach([&](int pitch) {
+      if (notes.test(pitch))
+        onsetSamples[pitch] = sampleTime;
+      else
+        releaseSamples[pitch] = sampleTime;
+    });
+    sounding = notes;
+  }
+  void clear() { sounding.clear(); }
+
+  const NoteMask &mask() const { return sounding; }
+  bool isOn(int pitch) const { return sounding.test(pitch); }
+  int count() const { return sounding.count(); }
+
+  uint8_t velocity(int pitch) const { return velocities[pitch]; }
+  uint8_t channel(int pitch) const { return channels[pitch]; }
+  int64_t onsetSample(int pitch) const { return onsetSamples[pitch]; }
+  int64_t releaseSample(int pitch) const { return releaseSamples[pitch]; }
+
+  // Time of the latest change to pitch, whichever direction it went
+  int64_t changeSample(int pitch) const {
+    return sounding.test(pitch) ? onsetSamples[pitch] : releaseSamples[pitch];
+  }
+
+private:
+  NoteMask sounding;
+  std::array<uint8_t, kNumMidiNotes> velocities{};
+  std::array<uint8_t, kNumMidiNotes> channels{};
+  std::array<int64_t, kNumMidiNotes> onsetSamples{};
+  std::array<int64_t, kNumMidiNotes> releaseSamples{};
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include "key_signature.h"
+#include "note_state.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Ursulean {
+
+//------------------------------------------------------------------------
+// Packed note transport between processor and controller
+//
+// The 128-bit NoteMask is split into 16-bit words, one read-only parameter
+// per word. A 16-bit integer is exactly representable as a normalized
+// double (word / 65535), so the mask survives the round trip bit for bit,
+// and a single note change only touches the one word that contains it.
+//------------------------------------------------------------------------
+static constexpr int kNoteMaskWordBits = 16;
+static constexpr int kNumNoteMaskWords = kNumMidiNotes / kNoteMaskWordBits;
+static constexpr int kNoteMaskWordMax = (1 << kNoteMaskWordBits) - 1;
+
+inline uint16_t getNoteMaskWord(const NoteMask &mask, int wordIndex) {
+  return static_cast<uint16_t>(mask.words[wordIndex >> 2] >>
+                               ((wordIndex & 3) * kNoteMaskWordBits));
+}
+
+inline void setNoteMaskWord(NoteMask &mask, int wordIndex, uint16_t value) {
+  const int shift = (wordIndex & 3) * kNoteMaskWordBits;
+  uint64_t &word = mask.words[wordIndex >> 2];
+  word = (word & ~((uint64_t)kNoteMaskWordMax << shift)) |
+         ((uint64_t)value << shift);
+}
+
+inline double noteMaskWordToNormalized(uint16_t value) {
+  return static_cast<double>(value) / kNoteMaskWordMax;
+}
+
+inline uint16_t normalizedToNoteMaskWord(double value) {
+  if (value <= 0.0)
+    return 0;
+  if (value >= 1.0)
+    return static_cast<uint16_t>(kNoteMaskWordMax);
+  return static_cast<uint16_t>(value * kNoteMaskWordMax + 0.5);
+}
+
+//------------------------------------------------------------------------
+// Song positions for the chord timeline
+//
+// Positions travel as quarter notes, offset so that a pre-roll before the
+// project start fits. 2^20 quarter notes is over 100 hours at 120 bpm and
+// still leaves the normalized double with far better than sample
+// resolution.
+//------------------------------------------------------------------------
+static constexpr double kMaxSongQuarters = 1 << 20;
+
+inline double songPositionToNormalized(double quarters) {
+  double value = (quarters + kMaxSongQuarters) / (2.0 * kMaxSongQuarters);
+  return value < 0.0 ? 0.0 : (value > 1.0 ? 1.0 : value);
+}
+
+inline double normalizedToSongPosition(double value) {
+  return value * (2.0 * kMaxSongQuarters) - kMaxSongQuarters;
+}
+
+//------------------------------------------------------------------------
+// Note transitions
+//
+// Every note change also goes out as a NoteTransition: the complete notes
+// it leads to, when it happened and, while the transport plays, where in
+// the song. Hosts hand output parameters to the controller in their own
+// order (queue by queue, by ID, or only the last point of each), so the
+// note mask words can't tell which notes belong to which of several changes
+// in a block. A transition is complete in itself instead, split over
+// kNumTransitionParts parameters that all carry its sequence number, and
+// the controller puts it back together whichever part comes last (see
+// NoteTransitionAssembler).
+//
+// Each part is a 52-bit integer, which a normalized double holds exactly,
+// ending in 8 bits of sequence number. Before that:
+//   notes     43, 43 and 42 bits of the mask, lowest notes first
+//   time      44 bits of microseconds of host time (wraps after 203 days)
+//   position  44 bits of 2^-23 quarter notes, offset as above
+//   tag       20 bits of bar, 4 of jumps, 4 of key and 1 for playing
+//   meter     30 bits of 2^-10 quarter notes a minute, then the time
+//             signature: 8 bits of beats and 6 of beat unit
+// The position and meter only go out while the transport plays.
+//------------------------------------------------------------------------
+struct NoteTransition {
+  NoteMask notes;
+  double time = 0.0;     // Seconds of host time
+  double position = 0.0; // Quarter notes from the project start
+  int32_t bar = 0;       // From 0
+  double tempo = 120.0;  // Quarter notes per minute
+  int32_t beatsPerBar = 4;
+  int32_t beatUnit = 4;
+  KeySignature key = kCMajor;
+  uint32_t jumps = 0;    // Wraps at kTransitionJumpCycle
+  uint32_t sequence = 0; // Wraps at kTransitionSequenceCycle
+  bool isPlaying = false; // Position to beatUnit are only set while playing
+};
+
+enum NoteTransitionPart {
+  kTransitionNotesLow = 0,
+  kTransitionNotesMid,
+  kTransitionNotesHigh,
+  kTransitionTime,
+  kTransitionPosition,
+  kTransitionTag,
+  kTransitionMeter,
+  kNumTransitionParts
+};
+
+static constexpr int kTransitionSequenceBits = 8;
+static constexpr uint32_t kTransitionSequenceCycle =
+    1u << kTransitionSequenceBits;
+static constexpr uint32_t kTransitionJumpCycle = 16;
+static constexpr int kTransitionNotesBits = 43; // Per notes part
+static constexpr int kTransitionFieldBits = 44; // Time, position, meter
+static constexpr int32_t kMaxSongBars = 1 << 19;
+static constexpr double kTransitionPositionTicks = 1 << 23; // Per quarter
+static constexpr double kTransitionMicros = 1000000.0;      // Per second
+static constexpr int kTransitionTempoBits = 30;
+static constexpr double kTransitionTempoSteps = 1 << 10; // Per bpm
+static constexpr int32_t kMaxTransitionBeats = (1 << 8) - 1;
+static constexpr int32_t kMaxTransitionBeatUnit = (1 << 6) - 1;
+static constexpr double kTransitionRange = 4503599627370496.0; // 2^52
+
+inline uint64_t getNoteMaskBits(const NoteMask &mask, int first, int count) {
+  int word = first >> 6;
+  int shift = first & 63;
+  uint64_t bits = mask.words[word] >> shift;
+  if (shift > 0 && word == 0)
+    bits |= mask.words[1] << (64 - shift);
+  return bits & ((1ull << count) - 1);
+}
+
+inline void setNoteMaskBits(NoteMask &mask, int first, int count,
+                            uint64_t bits) {
+  for (int i = 0; i < count; i++) {
+    if ((bits >> i) & 1)
+      mask.set(first + i);
+    else
+      mask.reset(first + i);
+  }
+}
+
+// The position and meter only go out while the transport plays
+inline bool isTransitionPartSent(const NoteTransition &transition,
+                                 int part) {
+  return transition.isPlaying ||
+         (part != kTransitionPosition && part != kTransitionMeter);
+}
+
+inline uint64_t normalizedToTransitionBits(double value) {
+  double bits = std::floor(value * kTransitionRange + 0.5);
+  if (bits <= 0.0)
+    return 0;
+  return static_cast<uint64_t>(std::min(bits, kTransitionRange - 1.0));
+}
+
+inline double transitionPartToNormalized(const NoteTransition &transition,
+                                         int part) {
+  const uint64_t fieldMask = (1ull << kTransitionFieldBits) - 1;
+  uint64_t bits = 0;
+  if (part <= kTransitionNotesHigh) {
+    int first = part * kTransitionNotesBits;
+    bits = getNoteMaskBits(transition.notes, first,
+                           std::min(kTransitionNotesBits,
+                                    kNumMidiNotes - first));
+  } else if (part == kTransitionTime) {
+    double micros = std::floor(transition.time * kTransitionMicros + 0.5);
+    bits = static_cast<uint64_t>(static_cast<int64_t>(micros)) & fieldMask;
+  } else if (part == kTransitionPosition) {
+    double quarters =
+        std::max(-kMaxSongQuarters,
+                 std::min(transition.position, kMaxSongQuarters - 1));
+    bits = static_cast<uint64_t>(std::floor(
+        (quarters + kMaxSongQuarters) * kTransitionPositionTicks + 0.5));
+  } else if (part == kTransitionMeter) {
+    const double maxTempo = ((1ull << kTransitionTempoBits) - 1) /
+                            kTransitionTempoSteps;
+    double tempo = std::max(0.0, std::min(transition.tempo, maxTempo));
+    bits = static_cast<uint64_t>(
+        std::floor(tempo * kTransitionTempoSteps + 0.5));
+    bits = (bits << 8) | static_cast<uint64_t>(std::max(
+                             1, std::min(transition.beatsPerBar,
+                                         kMaxTransitionBeats)));
+    bits = (bits << 6) | static_cast<uint64_t>(std::max(
+                             1, std::min(transition.beatUnit,
+                                         kMaxTransitionBeatUnit)));
+  } else {
+    int32_t bar = std::max(-kMaxSongBars,
+                           std::min(transition.bar, kMaxSongBars - 1));
+    bits = static_cast<uint64_t>(bar + kMaxSongBars);
+    bits = (bits << 4) | (transition.jumps % kTransitionJumpCycle);
+    bits = (bits << 4) | static_cast<uint64_t>(transition.key);
+    bits = (bits << 1) | (transition.isPlaying ? 1 : 0);
+  }
+  bits = (bits << kTransitionSequenceBits) |
+         (transition.sequence % kTransitionSequenceCycle);
+  return static_cast<double>(bits) / kTransitionRange;
+}
+
+// Fill in the fields part carries, and the sequence number
+inline void normalizedToTransitionPart(double value, int part,
+                                       NoteTransition &transition) {
+  uint64_t bits = normalizedToTransitionBits(value);
+  transition.sequence =
+      static_cast<uint32_t>(bits % kTransitionSequenceCycle);
+  bits >>= kTransitionSequenceBits;
+  if (part <= kTransitionNotesHigh) {
+    int first = part * kTransitionNotesBits;
+    setNoteMaskBits(transition.notes, first,
+                    std::min(kTransitionNotesBits, kNumMidiNotes - first),
+                    bits);
+  } else if (part == kTransitionTime) {
+    transition.time = bits / kTransitionMicros;
+  } else if (part == kTransitionPosition) {
+    transition.position = bits / kTransitionPositionTicks - kMaxSongQuarters;
+  } else if (part == kTransitionMeter) {
+    transition.beatUnit = static_cast<int32_t>(bits & kMaxTransitionBeatUnit);
+    transition.beatsPerBar =
+        static_cast<int32_t>((bits >> 6) & kMaxTransitionBeats);
+    transition.tempo = (bits >> 14) / kTransitionTempoSteps;
+  } else {
+    transition.isPlaying = (bits & 1) != 0;
+    int key = static_cast<int>((bits >> 1) & 0xF);
+    transition.key =
+        key < kNumKeySigs ? static_cast<KeySignature>(key) : kCMajor;
+    transition.jumps = static_cast<uint32_t>((bits >> 5) & 0xF);
+    transition.bar = static_cast<int32_t>(bits >> 9) - kMaxSongBars;
+  }
+}
+
+//------------------------------------------------------------------------
+// NoteTransitionAssembler - Puts transitions back together from their
+// parts, in whatever order the controller receives them
+//
+// A part joins the transition with its sequence number that is still
+// missing parts. A part that transition already has starts a new one in its
+// place instead: the sequence number came round again and the rest of the
+// old one was lost. The processor never sends more than half a cycle of
+// transitions in one block, so parts of different transitions can't meet
+// in the same place. UI thread only.
+//------------------------------------------------------------------------
+class NoteTransitionAssembler {
+public:
+  // Returns true if value completed a transition, readable through
+  // getTransition() until the next call
+  bool add(int part, double value) {
+    if (part < 0 || part >= kNumTransitionParts)
+      return false;
+    uint64_t bits = normalizedToTransitionBits(value);
+    Pending &pending = slots[bits % kTransitionSequenceCycle];
+    uint32_t partBit = 1u << part;
+    if (pending.parts & partBit)
+      pending = Pending();
+    normalizedToTransitionPart(value, part, pending.transition);
+    pending.parts |= partBit;
+
+    // Which parts to wait for is only known once the tag says whether the
+    // transport played
+    const uint32_t tagBit = 1u << kTransitionTag;
+    uint32_t needed = tagBit;
+    if (pending.parts & tagBit) {
+      for (int i = 0; i < kNumTransitionParts; i++) {
+        if (isTransitionPartSent(pending.transition, i))
+          needed |= 1u << i;
+      }
+    }
+    if ((pending.parts & needed) != needed)
+      return false;
+
+    transition = pending.transition;
+    pending = Pending();
+    return true;
+  }
+
+  const NoteTransition &getTransition() const { return transition; }
+
+private:
+  struct Pending {
+    NoteTransition transition;
+    uint32_t parts = 0; // Bit per NoteTransitionPart received
+  };
+
+  Pending slots[kTransitionSequenceCycle];
+  NoteTransition transition;
+};
+
+//------------------------------------------------------------------------
+} // namespace Ursulean
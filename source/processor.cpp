@@ -4,20 +4,99 @@
 
 #include "processor.h"
 #include "cids.h"
-#include "controller.h"
 
 #include "base/source/fstreamer.h"
 #include "pluginterfaces/vst/ivstevents.h"
 #include "pluginterfaces/vst/ivstparameterchanges.h"
 
+#include <cmath>
+
 using namespace Steinberg;
 
 namespace Ursulean {
+
+namespace {
+// Routes NoteProcessor's packed note words and detected keys into the
+// host's output queue
+class ParameterChangesOutput : public ControllerOutput {
+public:
+  explicit ParameterChangesOutput(Vst::IParameterChanges *changes)
+      : changes(changes) {}
+
+  bool sendNoteMaskWord(int wordIndex, uint16_t word,
+                        int32_t sampleOffset) override {
+    return addPoint(kNoteMaskFirstParam + wordIndex,
+                    noteMaskWordToNormalized(word), sampleOffset);
+  }
+
+  bool sendKeySignature(KeySignature key, int32_t sampleOffset) override {
+    return addPoint(kKeySignatureParam,
+                    static_cast<Vst::ParamValue>(key) / (kNumKeySigs - 1),
+                    sampleOffset);
+  }
+
+  bool sendTransition(const NoteTransition &transition,
+                      int32_t sampleOffset) override {
+    bool sentAll = true;
+    for (int part = 0; part < kNumTransitionParts; part++) {
+      if (!isTransitionPartSent(transition, part))
+        continue;
+      sentAll &= addPoint(kTransitionFirstParam + part,
+                          transitionPartToNormalized(transition, part),
+                          sampleOffset);
+    }
+    return sentAll;
+  }
+
+  bool sendLocate(double quarters, int32_t sampleOffset) override {
+    return addPoint(kLocateParam, songPositionToNormalized(quarters),
+                    sampleOffset);
+  }
+
+private:
+  bool addPoint(Vst::ParamID id, Vst::ParamValue value, int32 sampleOffset) {
+    int32 queueIndex = 0;
+    auto *paramQueue = changes->addParameterData(id, queueIndex);
+    int32 pointIndex = 0;
+    return paramQueue &&
+           paramQueue->addPoint(sampleOffset, value, pointIndex) == kResultOk;
+  }
+
+  Vst::IParameterChanges *changes;
+};
+
+// The host's musical position, if it gives one. Hosts without a bar
+// position are assumed to have kept the same time signature throughout.
+bool getMusicalTime(const Vst::ProcessContext *context, MusicalTime &time) {
+  using Context = Vst::ProcessContext;
+  if (!context || !(context->state & Context::kProjectTimeMusicValid))
+    return false;
+
+  time.position = context->projectTimeMusic;
+  time.isPlaying = (context->state & Context::kPlaying) != 0;
+  if ((context->state & Context::kTempoValid) && context->tempo > 0)
+    time.tempo = context->tempo;
+  if ((context->state & Context::kTimeSigValid) &&
+      context->timeSigNumerator > 0 && context->timeSigDenominator > 0) {
+    time.beatsPerBar = context->timeSigNumerator;
+    time.beatUnit = context->timeSigDenominator;
+    time.quartersPerBar = time.beatsPerBar * 4.0 / time.beatUnit;
+  }
+
+  double barLength = time.quartersPerBar;
+  if (context->state & Context::kBarPositionValid)
+    time.barStart = context->barPositionMusic;
+  else
+    time.barStart = std::floor(time.position / barLength) * barLength;
+  time.bar = static_cast<int32_t>(std::floor(time.barStart / barLength + 0.5));
+  return true;
+}
+} // namespace
+
 //------------------------------------------------------------------------
 // NotationChordHelperProcessor
 //------------------------------------------------------------------------
-NotationChordHelperProcessor::NotationChordHelperProcessor()
-    : currentKeySignature(kCMajor) {
+NotationChordHelperProcessor::NotationChordHelperProcessor() {
   //--- set the wanted controller for our processor
   setControllerClass(kNotationChordHelperControllerUID);
 }
@@ -37,8 +116,11 @@ tresult PLUGIN_API NotationChordHelperProcessor::initialize(FUnknown *context) {
   }
 
   //--- create Audio IO ------
-  // addAudioInput (STR16 ("Stereo In"), Steinberg::Vst::SpeakerArr::kStereo);
+  // The output only exists for hosts that insist on instruments having one;
+  // it is always silent
+#if !NOTATION_HELPER_EVENT_ONLY
   addAudioOutput(STR16("Stereo Out"), Steinberg::Vst::SpeakerArr::kStereo);
+#endif
 
   /* If you don't need an event bus, you can remove the next line */
   addEventInput(STR16("Event In"), 1);
@@ -58,10 +140,13 @@ tresult PLUGIN_API NotationChordHelperProcessor::terminate() {
 //------------------------------------------------------------------------
 tresult PLUGIN_API NotationChordHelperProcessor::setActive(TBool state) {
   //--- called when the Plug-in is enable/disable (On/Off) -----
-  if (!state) {
-    // Clear active notes when plugin is deactivated
-    std::lock_guard<std::mutex> lock(activeNotesMutex);
-    activeNotes.clear();
+  if (state) {
+    keyDetection.start();
+  } else {
+    // Clear active notes when plugin is deactivated. The host never calls
+    // process() concurrently with setActive(), so this is safe without a lock.
+    keyDetection.stop();
+    notes.reset();
   }
   return AudioEffect::setActive(state);
 }
@@ -69,178 +154,144 @@ tresult PLUGIN_API NotationChordHelperProcessor::setActive(TBool state) {
 //------------------------------------------------------------------------
 tresult PLUGIN_API
 NotationChordHelperProcessor::process(Vst::ProcessData &data) {
-  //--- Process MIDI events first
-  if (data.inputEvents) {
-    processMidiEvents(data.inputEvents);
-  }
-
-  // Send parameter updates if notes changed
-  if (activeNotesChanged && data.outputParameterChanges) {
-    std::lock_guard<std::mutex> lock(activeNotesMutex);
-
-    // Convert active notes to vector and limit to 10 notes max
-    std::vector<int> notesList(activeNotes.begin(), activeNotes.end());
-    if (notesList.size() > 10) {
-      notesList.resize(10); // Limit to first 10 notes
-    }
-
-    // Send each note to its corresponding parameter slot
-    for (int i = 0; i < 10; i++) {
-      int32 index = 0;
-      auto *paramQueue =
-          data.outputParameterChanges->addParameterData(i, index);
-      if (paramQueue) {
-        if (i < notesList.size()) {
-          // Send the note as normalized value (0-127 maps to 0.0-1.0)
-          double paramValue = static_cast<double>(notesList[i]) / 127.0;
-          paramQueue->addPoint(0, paramValue, index);
-        } else {
-          // No note for this slot, send 0.0
-          paramQueue->addPoint(0, 0.0, index);
-        }
-      }
-    }
-
-    activeNotesChanged = false;
-  }
-
   //--- First : Read inputs parameter changes-----------
   if (data.inputParameterChanges) {
-    int32 numParamsChanged = data.inputParameterChanges->getParameterCount();
-    for (int32 index = 0; index < numParamsChanged; index++) {
-      if (auto *paramQueue =
-              data.inputParameterChanges->getParameterData(index)) {
-        Vst::ParamValue value;
-        int32 sampleOffset;
-        int32 numPoints = paramQueue->getPointCount();
-        if (numPoints > 0) {
-          // Get the last value in the queue
-          paramQueue->getPoint(numPoints - 1, sampleOffset, value);
-
-          switch (paramQueue->getParameterId()) {
-          case kKeySignatureParam: {
-            int keyIndex = static_cast<int>(value * (kNumKeySigs - 1) + 0.5);
-            if (keyIndex >= 0 && keyIndex < kNumKeySigs) {
-              currentKeySignature = static_cast<KeySignature>(keyIndex);
-            }
-          } break;
-          default:
-            break;
-          }
-        }
-      }
-    }
+    processInputParameters(data.inputParameterChanges);
   }
 
-  //--- Here you have to implement your processing
+  //--- Process MIDI events. Output points are written at the sample
+  // offset of each transition, so several chord changes inside one block
+  // stay distinct for the controller.
+  const Vst::ProcessContext *context = data.processContext;
+  bool hasContinuousTime =
+      context && (context->state & Vst::ProcessContext::kContTimeValid);
+  ParameterChangesOutput output(data.outputParameterChanges);
+  MusicalTime musicalTime;
+  bool hasMusicalTime = getMusicalTime(context, musicalTime);
+  notes.beginBlock(data.numSamples, hasContinuousTime,
+                   hasContinuousTime ? context->continousTimeSamples : 0,
+                   data.outputParameterChanges ? &output : nullptr,
+                   hasMusicalTime ? &musicalTime : nullptr);
+  if (data.inputEvents && !notes.isBypassed()) {
+    processMidiEvents(data.inputEvents);
+  }
+  notes.endBlock();
 
+  //--- This plug-in never produces audio; just keep any outputs silent
+#if !NOTATION_HELPER_EVENT_ONLY
   if (data.numSamples > 0) {
-    //--- ------------------------------------------
-    // here as example a default implementation where we try to copy the
-    // inputs to the outputs: if less input than outputs then clear outputs
-    //--- ------------------------------------------
-
-    int32 minBus = std::min(data.numInputs, data.numOutputs);
-    for (int32 i = 0; i < minBus; i++) {
-      int32 minChan =
-          std::min(data.inputs[i].numChannels, data.outputs[i].numChannels);
-      for (int32 c = 0; c < minChan; c++) {
-        // do not need to be copied if the buffers are the same
-        if (data.outputs[i].channelBuffers32[c] !=
-            data.inputs[i].channelBuffers32[c]) {
-          memcpy(data.outputs[i].channelBuffers32[c],
-                 data.inputs[i].channelBuffers32[c],
-                 data.numSamples * sizeof(Vst::Sample32));
-        }
-      }
-      data.outputs[i].silenceFlags = data.inputs[i].silenceFlags;
-
-      // clear the remaining output buffers
-      for (int32 c = minChan; c < data.outputs[i].numChannels; c++) {
-        // clear output buffers
-        memset(data.outputs[i].channelBuffers32[c], 0,
-               data.numSamples * sizeof(Vst::Sample32));
-
-        // inform the host that this channel is silent
-        data.outputs[i].silenceFlags |= ((uint64)1 << c);
-      }
-    }
-    // clear the remaining output buffers
-    for (int32 i = minBus; i < data.numOutputs; i++) {
-      // clear output buffers
-      for (int32 c = 0; c < data.outputs[i].numChannels; c++) {
-        memset(data.outputs[i].channelBuffers32[c], 0,
-               data.numSamples * sizeof(Vst::Sample32));
-      }
-      // inform the host that this bus is silent
-      data.outputs[i].silenceFlags =
-          ((uint64)1 << data.outputs[i].numChannels) - 1;
-    }
+    clearAudioOutputs(data);
   }
+#endif
 
   return kResultOk;
 }
 
 //------------------------------------------------------------------------
-void NotationChordHelperProcessor::processMidiEvents(Vst::IEventList *events) {
-  if (!events)
-    return;
-
-  int32 numEvents = events->getEventCount();
-  for (int32 i = 0; i < numEvents; i++) {
-    Vst::Event event;
-    if (events->getEvent(i, event) == kResultOk) {
-      switch (event.type) {
-      case Vst::Event::kNoteOnEvent:
-        if (event.noteOn.velocity > 0) {
-          handleNoteOn(event.noteOn.pitch, event.noteOn.velocity);
-        } else {
-          // Velocity 0 is treated as note off
-          handleNoteOff(event.noteOn.pitch);
+void NotationChordHelperProcessor::processInputParameters(
+    Vst::IParameterChanges *changes) {
+  int32 numParamsChanged = changes->getParameterCount();
+  for (int32 index = 0; index < numParamsChanged; index++) {
+    if (auto *paramQueue = changes->getParameterData(index)) {
+      Vst::ParamValue value;
+      int32 sampleOffset;
+      int32 numPoints = paramQueue->getPointCount();
+      if (numPoints > 0) {
+        // Get the last value in the queue
+        paramQueue->getPoint(numPoints - 1, sampleOffset, value);
+
+        switch (paramQueue->getParameterId()) {
+        case kKeySignatureParam: {
+          int keyIndex = static_cast<int>(value * (kNumKeySigs - 1) + 0.5);
+          if (keyIndex >= 0 && keyIndex < kNumKeySigs) {
+            notes.setKeySignature(static_cast<KeySignature>(keyIndex));
+          }
+        } break;
+        case kBypassParam:
+          notes.setBypassed(value >= 0.5);
+          break;
+        case kAutoKeyParam:
+          notes.setAutoKey(value >= 0.5);
+          break;
+        default:
+          break;
         }
-        break;
-      case Vst::Event::kNoteOffEvent:
-        handleNoteOff(event.noteOff.pitch);
-        break;
-      default:
-        break;
       }
     }
   }
 }
 
 //------------------------------------------------------------------------
-void NotationChordHelperProcessor::handleNoteOn(int pitch, int velocity) {
-  std::lock_guard<std::mutex> lock(activeNotesMutex);
-  activeNotes.insert(pitch);
-  activeNotesChanged = true;
+void NotationChordHelperProcessor::clearAudioOutputs(Vst::ProcessData &data) {
+  const bool is64Bit = data.symbolicSampleSize == Vst::kSample64;
+  const size_t sampleBytes =
+      is64Bit ? sizeof(Vst::Sample64) : sizeof(Vst::Sample32);
+  const size_t numBytes = data.numSamples * sampleBytes;
+
+  for (int32 i = 0; i < data.numOutputs; i++) {
+    Vst::AudioBusBuffers &bus = data.outputs[i];
+    void **channels = is64Bit ? reinterpret_cast<void **>(bus.channelBuffers64)
+                              : reinterpret_cast<void **>(bus.channelBuffers32);
+    if (channels) {
+      for (int32 c = 0; c < bus.numChannels; c++) {
+        if (channels[c])
+          memset(channels[c], 0, numBytes);
+      }
+    }
+
+    // inform the host that the whole bus is silent, in one store
+    bus.silenceFlags = bus.numChannels >= 64
+                           ? ~(uint64)0
+                           : ((uint64)1 << bus.numChannels) - 1;
+  }
 }
 
 //------------------------------------------------------------------------
-void NotationChordHelperProcessor::handleNoteOff(int pitch) {
-  std::lock_guard<std::mutex> lock(activeNotesMutex);
-  activeNotes.erase(pitch);
-  activeNotesChanged = true;
+void NotationChordHelperProcessor::processMidiEvents(Vst::IEventList *events) {
+  // IEventList only hands out copies, so reuse one Event for the whole block
+  // and reject anything that isn't a note on/off before looking further
+  Vst::Event event;
+  MidiNoteInput note;
+  int32 numEvents = events->getEventCount();
+  for (int32 i = 0; i < numEvents; i++) {
+    if (events->getEvent(i, event) != kResultOk)
+      continue;
+
+    if (event.type == Vst::Event::kNoteOnEvent) {
+      note.pitch = event.noteOn.pitch;
+      note.velocity = event.noteOn.velocity;
+      note.channel = event.noteOn.channel;
+      note.isNoteOn = true;
+    } else if (event.type == Vst::Event::kNoteOffEvent) {
+      note.pitch = event.noteOff.pitch;
+      note.velocity = 0.f;
+      note.channel = event.noteOff.channel;
+      note.isNoteOn = false;
+    } else {
+      continue; // Poly pressure, note expression, sysex, ...
+    }
+    note.sampleOffset = event.sampleOffset;
+    notes.addNote(note);
+  }
 }
 
 //------------------------------------------------------------------------
 tresult PLUGIN_API
 NotationChordHelperProcessor::setupProcessing(Vst::ProcessSetup &newSetup) {
   //--- called before any processing ----
+  notes.setSampleRate(newSetup.sampleRate);
+  keyDetection.setSampleRate(newSetup.sampleRate);
   return AudioEffect::setupProcessing(newSetup);
 }
 
 //------------------------------------------------------------------------
 tresult PLUGIN_API
 NotationChordHelperProcessor::canProcessSampleSize(int32 symbolicSampleSize) {
-  // by default kSample32 is supported
-  if (symbolicSampleSize == Vst::kSample32)
+  // Outputs are only ever cleared, which works for either sample size
+  if (symbolicSampleSize == Vst::kSample32 ||
+      symbolicSampleSize == Vst::kSample64)
     return kResultTrue;
 
-  // disable the following comment if your processing support kSample64
-  /* if (symbolicSampleSize == Vst::kSample64)
-          return kResultTrue; */
-
   return kResultFalse;
 }
 
@@ -254,29 +305,42 @@ tresult PLUGIN_API NotationChordHelperProcessor::setState(IBStream *state) {
 
   // Read key signature
   int32 keySig = 0;
-  if (streamer.readInt32(keySig) == kResultFalse)
+  if (!streamer.readInt32(keySig))
     return kResultFalse;
   if (keySig >= 0 && keySig < kNumKeySigs) {
-    currentKeySignature = static_cast<KeySignature>(keySig);
+    notes.setKeySignature(static_cast<KeySignature>(keySig));
   }
 
   // Read active notes from state
   int32 numNotes = 0;
-  if (streamer.readInt32(numNotes) == kResultFalse)
+  if (!streamer.readInt32(numNotes))
     return kResultFalse;
 
-  std::lock_guard<std::mutex> lock(activeNotesMutex);
-  activeNotes.clear();
-
+  // Collect the notes here and hand them to the audio thread, which owns
+  // the note state and applies them at the start of its next block
+  NoteMask restored;
   for (int32 i = 0; i < numNotes; i++) {
     int32 note = 0;
-    if (streamer.readInt32(note) == kResultFalse)
+    if (!streamer.readInt32(note))
       return kResultFalse;
-    if (note >= 0 && note <= 127) {
-      activeNotes.insert(note);
+    if (note >= 0 && note < kNumMidiNotes) {
+      restored.set(note);
     }
   }
 
+  // Bypass was appended later; older states simply end here
+  int32 bypass = 0;
+  if (streamer.readInt32(bypass)) {
+    notes.setBypassed(bypass != 0);
+  }
+
+  // As is auto key, after bypass
+  int32 autoKey = 0;
+  if (streamer.readInt32(autoKey)) {
+    notes.setAutoKey(autoKey != 0);
+  }
+  notes.restoreNotes(restored);
+
   return kResultOk;
 }
 
@@ -289,23 +353,32 @@ tresult PLUGIN_API NotationChordHelperProcessor::getState(IBStream *state) {
   IBStreamer streamer(state, kLittleEndian);
 
   // Write key signature to state
-  if (streamer.writeInt32(static_cast<int32>(currentKeySignature)) ==
-      kResultFalse)
+  if (!streamer.writeInt32(static_cast<int32>(notes.getKeySignature())))
     return kResultFalse;
 
-  // Write active notes to state
-  std::lock_guard<std::mutex> lock(activeNotesMutex);
+  // Write active notes to state, as last published by the audio thread
+  NoteMask snapshot = notes.getActiveNoteMask();
 
   // Write number of active notes
-  int32 numNotes = static_cast<int32>(activeNotes.size());
-  if (streamer.writeInt32(numNotes) == kResultFalse)
+  int32 numNotes = static_cast<int32>(snapshot.count());
+  if (!streamer.writeInt32(numNotes))
     return kResultFalse;
 
   // Write each note
-  for (int note : activeNotes) {
-    if (streamer.writeInt32(static_cast<int32>(note)) == kResultFalse)
-      return kResultFalse;
-  }
+  bool writeOk = true;
+  snapshot.forEach([&](int note) {
+    writeOk = writeOk && streamer.writeInt32(static_cast<int32>(note));
+  });
+  if (!writeOk)
+    return kResultFalse;
+
+  // Write bypass state
+  if (!streamer.writeInt32(notes.isBypassed() ? 1 : 0))
+    return kResultFalse;
+
+  // Write auto key state
+  if (!streamer.writeInt32(notes.isAutoKey() ? 1 : 0))
+    return kResultFalse;
 
   return kResultOk;
 }
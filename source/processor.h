@@ -4,11 +4,11 @@
 
 #pragma once
 
-#include "key_signature.h"
+#include "key_detection_thread.h"
+#include "note_processor.h"
 #include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
 #include "public.sdk/source/vst/vstaudioeffect.h"
-#include <mutex>
-#include <set>
 #include <vector>
 
 namespace Ursulean {
@@ -57,23 +57,30 @@ public:
   Steinberg::tresult PLUGIN_API getState(Steinberg::IBStream *state)
       SMTG_OVERRIDE;
 
-  // Get currently active notes for the UI
+  // Get currently active notes for the UI (never blocks the audio thread)
+  NoteMask getActiveNoteMask() const { return notes.getActiveNoteMask(); }
   std::vector<int> getActiveNotes() const {
-    std::lock_guard<std::mutex> lock(activeNotesMutex);
-    return std::vector<int>(activeNotes.begin(), activeNotes.end());
+    NoteMask active = notes.getActiveNoteMask();
+    std::vector<int> result;
+    result.reserve(active.count());
+    active.forEach([&](int note) { result.push_back(note); });
+    return result;
+  }
+
+  // Output parameter points emitted by process()
+  NoteProcessor::OutputPointStats getOutputPointStats() const {
+    return notes.getOutputPointStats();
   }
 
   //------------------------------------------------------------------------
 protected:
+  void processInputParameters(Steinberg::Vst::IParameterChanges *changes);
   void processMidiEvents(Steinberg::Vst::IEventList *events);
-  void handleNoteOn(int pitch, int velocity);
-  void handleNoteOff(int pitch);
+  void clearAudioOutputs(Steinberg::Vst::ProcessData &data);
 
 private:
-  std::set<int> activeNotes;           // Currently pressed MIDI notes (0-127)
-  mutable std::mutex activeNotesMutex; // Protect access to activeNotes
-  bool activeNotesChanged = false;     // Flag to indicate notes have changed
-  KeySignature currentKeySignature;    // Current key signature setting
+  NoteProcessor notes; // Note tracking, shared with the benchmarks
+  KeyDetectionThread keyDetection{notes}; // Runs while active
 };
 
 //------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Command-line chord export
+//
+// Converts a chord capture saved from the editor into MusicXML and/or a
+// Standard MIDI File, the same way the editor's export does, without a
+// host:
+//
+//   ChordExport capture.chords [--musicxml out.musicxml] [--midi out.mid]
+//               [--time 3/4] [--tempo 96]
+//
+// The meter and tempo are the ones the capture was recorded in, unless
+// --time or --tempo say otherwise. The capture is streamed, so memory use
+// doesn't grow with its length.
+//
+//------------------------------------------------------------------------
+
+#include "chord_capture.h"
+#include "chord_export.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Ursulean;
+
+namespace {
+
+//------------------------------------------------------------------------
+int usage() {
+  std::fprintf(stderr,
+               "usage: ChordExport capture.chords [--musicxml file] "
+               "[--midi file]\n"
+               "                   [--time beats/unit] [--tempo bpm]\n");
+  return 2;
+}
+
+//------------------------------------------------------------------------
+// Each format reads the capture from the start
+bool exportCapture(const char *capturePath, const char *outputPath,
+                   const ExportOptions &options, bool isMidi) {
+  ChordCaptureReader reader;
+  if (!reader.open(capturePath)) {
+    std::fprintf(stderr, "Can't read capture %s\n", capturePath);
+    return false;
+  }
+
+  bool written = isMidi ? writeMidiFile(reader, options, outputPath)
+                        : writeMusicXml(reader, options, outputPath);
+  if (!written)
+    std::fprintf(stderr, "Can't write %s\n", outputPath);
+  return written;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main(int argc, char **argv) {
+  if (argc < 2)
+    return usage();
+
+  const char *capturePath = argv[1];
+  const char *musicXmlPath = nullptr;
+  const char *midiPath = nullptr;
+
+  ChordCaptureReader capture;
+  if (!capture.open(capturePath)) {
+    std::fprintf(stderr, "Can't read capture %s\n", capturePath);
+    return 1;
+  }
+  ExportOptions options = getExportOptions(capture.getMeter());
+
+  for (int i = 2; i < argc; i++) {
+    if (i + 1 >= argc)
+      return usage();
+    const char *value = argv[++i];
+    if (std::strcmp(argv[i - 1], "--musicxml") == 0) {
+      musicXmlPath = value;
+    } else if (std::strcmp(argv[i - 1], "--midi") == 0) {
+      midiPath = value;
+    } else if (std::strcmp(argv[i - 1], "--time") == 0) {
+      if (std::sscanf(value, "%d/%d", &options.beatsPerBar,
+                      &options.beatUnit) != 2)
+        return usage();
+    } else if (std::strcmp(argv[i - 1], "--tempo") == 0) {
+      options.tempo = std::atof(value);
+    } else {
+      return usage();
+    }
+  }
+
+  if (!musicXmlPath && !midiPath)
+    return usage();
+  if (!isValidExportOptions(options)) {
+    std::fprintf(stderr, "Unsupported time signature or tempo\n");
+    return 2;
+  }
+
+  bool ok = true;
+  if (musicXmlPath)
+    ok = exportCapture(capturePath, musicXmlPath, options, false) && ok;
+  if (midiPath)
+    ok = exportCapture(capturePath, midiPath, options, true) && ok;
+  return ok ? 0 : 1;
+}
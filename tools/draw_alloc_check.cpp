@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Allocation check for the notation redraw path
+//
+// Every repaint lays the chord out again (or takes it from the LayoutCache)
+// before playing back the display list. This tool warms NotationLayout and
+// LayoutCache up on a set of voicings in every key, replays them, and
+// counts the heap allocations made through operator new meanwhile. Exits
+// non-zero if a steady-state layout allocated.
+//
+// The drawing calls themselves go to VSTGUI and the platform and are not
+// covered; NotationView keeps its own part of them (fonts, bitmaps) cached.
+//
+//------------------------------------------------------------------------
+
+#include "layout_cache.h"
+#include "notation_layout.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+using namespace Ursulean;
+
+//------------------------------------------------------------------------
+// Allocation counter - only counts while a check is running
+//------------------------------------------------------------------------
+namespace {
+bool counting = false;
+int numAllocations = 0;
+} // namespace
+
+void *operator new(size_t size) {
+  if (counting)
+    numAllocations++;
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  if (counting)
+    numAllocations++;
+  return std::malloc(size ? size : 1);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return operator new(size, std::nothrow);
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+//------------------------------------------------------------------------
+std::vector<NoteMask> makeVoicings(size_t count, int minNotes, int maxNotes) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pitchDist(21, 108);
+  std::uniform_int_distribution<int> sizeDist(minNotes, maxNotes);
+  std::vector<NoteMask> voicings(count);
+  for (auto &mask : voicings) {
+    int numNotes = sizeDist(rng);
+    while (mask.count() < numNotes)
+      mask.set(pitchDist(rng));
+  }
+  return voicings;
+}
+
+//------------------------------------------------------------------------
+// Runs redraw() over every voicing in every key, once to warm up and once
+// counted
+template <typename Redraw>
+bool runCheck(const char *name, const std::vector<NoteMask> &voicings,
+              Redraw &&redraw) {
+  for (int pass = 0; pass < 2; pass++) {
+    counting = pass == 1;
+    numAllocations = 0;
+    for (int key = 0; key < kNumKeySigs; key++) {
+      for (const auto &mask : voicings)
+        redraw(mask, static_cast<KeySignature>(key));
+    }
+    counting = false;
+  }
+
+  bool passed = numAllocations == 0;
+  std::printf("%-44s %s (%d allocations)\n", name, passed ? "ok" : "FAILED",
+              numAllocations);
+  return passed;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  const double kWidth = 580.0; // The editor's notation view
+  const double kHeight = 390.0;
+
+  bool allPassed = true;
+
+  // Any chord, one layout reused
+  auto anyChords = makeVoicings(512, 0, 88);
+  NotationLayout layout;
+  allPassed &= runCheck("layout, 0-88 notes", anyChords,
+                        [&](const NoteMask &mask, KeySignature key) {
+                          layout.layout(mask, key, kWidth, kHeight);
+                        });
+
+  // Everyday chords through the cache, far more of them than it holds
+  auto everydayChords = makeVoicings(512, 0, 12);
+  LayoutCache cache;
+  allPassed &= runCheck("layout cache, 0-12 notes, mostly misses",
+                        everydayChords,
+                        [&](const NoteMask &mask, KeySignature key) {
+                          cache.layout(mask, key, kWidth, kHeight);
+                        });
+
+  if (allPassed)
+    std::printf("Steady-state redraws don't allocate\n");
+  else
+    std::printf("A steady-state redraw allocated\n");
+  return allPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
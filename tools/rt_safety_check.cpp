@@ -0,0 +1,544 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Real-time safety check for NotationChordHelperProcessor::process()
+//
+// Drives the processor with fixed-capacity stand-ins for the host's event
+// list and parameter change queues, and counts every heap allocation, free
+// and lock acquisition made on the calling thread while process() runs.
+// Exits non-zero if any block allocated or locked, so it can gate changes
+// to the audio path.
+//
+// Allocations are caught through the global operator new/delete on every
+// platform. On glibc the C allocator and the pthread locking functions are
+// interposed as well; elsewhere those two checks are reported as skipped.
+//
+//------------------------------------------------------------------------
+
+#include "cids.h"
+#include "processor.h"
+
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+#include "pluginterfaces/vst/ivstprocesscontext.h"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#define RT_CHECK_HOOKS_LIBC 1
+#else
+#define RT_CHECK_HOOKS_LIBC 0
+#endif
+
+using namespace Steinberg;
+using namespace Ursulean;
+
+//------------------------------------------------------------------------
+// Violation counters - only the thread inside a guarded region counts
+//------------------------------------------------------------------------
+namespace {
+
+struct Violations {
+  int allocations = 0;
+  int frees = 0;
+  int locks = 0;
+
+  bool any() const { return allocations || frees || locks; }
+};
+
+thread_local bool guardActive = false;
+thread_local Violations threadViolations;
+
+inline void noteAllocation() {
+  if (guardActive)
+    threadViolations.allocations++;
+}
+inline void noteFree(void *ptr) {
+  if (guardActive && ptr)
+    threadViolations.frees++;
+}
+inline void noteLock() {
+  if (guardActive)
+    threadViolations.locks++;
+}
+
+// Marks the region of the current thread that has to be real-time safe
+class RealtimeGuard {
+public:
+  RealtimeGuard() {
+    threadViolations = Violations();
+    guardActive = true;
+  }
+  ~RealtimeGuard() { guardActive = false; }
+
+  Violations violations() const { return threadViolations; }
+};
+
+} // namespace
+
+//------------------------------------------------------------------------
+// Allocation hooks
+//------------------------------------------------------------------------
+#if RT_CHECK_HOOKS_LIBC
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+  noteAllocation();
+  return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+  noteAllocation();
+  return __libc_calloc(count, size);
+}
+void *realloc(void *ptr, size_t size) {
+  noteAllocation();
+  return __libc_realloc(ptr, size);
+}
+void free(void *ptr) {
+  noteFree(ptr);
+  __libc_free(ptr);
+}
+}
+
+// operator new/delete count for themselves, so they bypass the hooks above
+static void *rawMalloc(size_t size) { return __libc_malloc(size); }
+static void rawFree(void *ptr) { __libc_free(ptr); }
+#else
+static void *rawMalloc(size_t size) { return std::malloc(size); }
+static void rawFree(void *ptr) { std::free(ptr); }
+#endif
+
+void *operator new(size_t size) {
+  noteAllocation();
+  if (void *ptr = rawMalloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  noteAllocation();
+  return rawMalloc(size ? size : 1);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return operator new(size, std::nothrow);
+}
+void operator delete(void *ptr) noexcept {
+  noteFree(ptr);
+  rawFree(ptr);
+}
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { operator delete(ptr); }
+
+// Over-aligned allocations (e.g. the processor's cache-line aligned queue)
+void *operator new(size_t size, std::align_val_t alignment) {
+  noteAllocation();
+  size_t align = static_cast<size_t>(alignment);
+  void *ptr = nullptr;
+#if defined(_MSC_VER)
+  ptr = _aligned_malloc(size ? size : 1, align);
+#else
+  if (posix_memalign(&ptr, align, size ? size : 1) != 0)
+    ptr = nullptr;
+#endif
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+void operator delete(void *ptr, std::align_val_t) noexcept {
+  noteFree(ptr);
+#if defined(_MSC_VER)
+  _aligned_free(ptr);
+#else
+  rawFree(ptr);
+#endif
+}
+void operator delete(void *ptr, size_t, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+//------------------------------------------------------------------------
+// Lock hooks
+//------------------------------------------------------------------------
+#if RT_CHECK_HOOKS_LIBC
+namespace {
+using MutexFn = int (*)(pthread_mutex_t *);
+using RwLockFn = int (*)(pthread_rwlock_t *);
+
+MutexFn realMutexLock = nullptr;
+MutexFn realMutexTryLock = nullptr;
+RwLockFn realRwLockRead = nullptr;
+RwLockFn realRwLockWrite = nullptr;
+
+// Resolved up front so dlsym never runs inside a guarded region
+void resolveLockFunctions() {
+  realMutexLock =
+      reinterpret_cast<MutexFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+  realMutexTryLock =
+      reinterpret_cast<MutexFn>(dlsym(RTLD_NEXT, "pthread_mutex_trylock"));
+  realRwLockRead =
+      reinterpret_cast<RwLockFn>(dlsym(RTLD_NEXT, "pthread_rwlock_rdlock"));
+  realRwLockWrite =
+      reinterpret_cast<RwLockFn>(dlsym(RTLD_NEXT, "pthread_rwlock_wrlock"));
+}
+} // namespace
+
+extern "C" {
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+  noteLock();
+  return realMutexLock(mutex);
+}
+int pthread_mutex_trylock(pthread_mutex_t *mutex) {
+  noteLock();
+  return realMutexTryLock(mutex);
+}
+int pthread_rwlock_rdlock(pthread_rwlock_t *lock) {
+  noteLock();
+  return realRwLockRead(lock);
+}
+int pthread_rwlock_wrlock(pthread_rwlock_t *lock) {
+  noteLock();
+  return realRwLockWrite(lock);
+}
+}
+#endif
+
+//------------------------------------------------------------------------
+// Host stand-ins - all storage is preallocated so that only the
+// processor's own behaviour shows up in the counters
+//------------------------------------------------------------------------
+namespace {
+
+#define RT_CHECK_FUNKNOWN_STUB                                                 \
+  tresult PLUGIN_API queryInterface(const TUID, void **obj) override {         \
+    *obj = nullptr;                                                            \
+    return kNoInterface;                                                       \
+  }                                                                            \
+  uint32 PLUGIN_API addRef() override { return 1; }                            \
+  uint32 PLUGIN_API release() override { return 1; }
+
+//------------------------------------------------------------------------
+class FixedEventList : public Vst::IEventList {
+public:
+  RT_CHECK_FUNKNOWN_STUB
+
+  int32 PLUGIN_API getEventCount() override { return numEvents; }
+  tresult PLUGIN_API getEvent(int32 index, Vst::Event &e) override {
+    if (index < 0 || index >= numEvents)
+      return kInvalidArgument;
+    e = events[index];
+    return kResultOk;
+  }
+  tresult PLUGIN_API addEvent(Vst::Event &e) override {
+    if (numEvents >= static_cast<int32>(events.size()))
+      return kResultFalse;
+    events[numEvents++] = e;
+    return kResultOk;
+  }
+
+  void clear() { numEvents = 0; }
+  void addNote(int32 sampleOffset, int pitch, bool isNoteOn) {
+    Vst::Event e = {};
+    e.sampleOffset = sampleOffset;
+    if (isNoteOn) {
+      e.type = Vst::Event::kNoteOnEvent;
+      e.noteOn.pitch = static_cast<int16>(pitch);
+      e.noteOn.velocity = 0.8f;
+    } else {
+      e.type = Vst::Event::kNoteOffEvent;
+      e.noteOff.pitch = static_cast<int16>(pitch);
+    }
+    addEvent(e);
+  }
+  void addPolyPressure(int32 sampleOffset, int pitch) {
+    Vst::Event e = {};
+    e.sampleOffset = sampleOffset;
+    e.type = Vst::Event::kPolyPressureEvent;
+    e.polyPressure.pitch = static_cast<int16>(pitch);
+    e.polyPressure.pressure = 0.5f;
+    addEvent(e);
+  }
+
+private:
+  std::array<Vst::Event, 2048> events;
+  int32 numEvents = 0;
+};
+
+//------------------------------------------------------------------------
+class FixedParamValueQueue : public Vst::IParamValueQueue {
+public:
+  RT_CHECK_FUNKNOWN_STUB
+
+  Vst::ParamID PLUGIN_API getParameterId() override { return paramId; }
+  int32 PLUGIN_API getPointCount() override { return numPoints; }
+  tresult PLUGIN_API getPoint(int32 index, int32 &sampleOffset,
+                              Vst::ParamValue &value) override {
+    if (index < 0 || index >= numPoints)
+      return kInvalidArgument;
+    sampleOffset = offsets[index];
+    value = values[index];
+    return kResultOk;
+  }
+  tresult PLUGIN_API addPoint(int32 sampleOffset, Vst::ParamValue value,
+                              int32 &index) override {
+    if (numPoints >= static_cast<int32>(values.size()))
+      return kResultFalse;
+    index = numPoints++;
+    offsets[index] = sampleOffset;
+    values[index] = value;
+    return kResultOk;
+  }
+
+  void reset(Vst::ParamID id) {
+    paramId = id;
+    numPoints = 0;
+  }
+
+private:
+  Vst::ParamID paramId = 0;
+  std::array<int32, 512> offsets{};
+  std::array<Vst::ParamValue, 512> values{};
+  int32 numPoints = 0;
+};
+
+//------------------------------------------------------------------------
+class FixedParameterChanges : public Vst::IParameterChanges {
+public:
+  RT_CHECK_FUNKNOWN_STUB
+
+  int32 PLUGIN_API getParameterCount() override { return numQueues; }
+  Vst::IParamValueQueue *PLUGIN_API getParameterData(int32 index) override {
+    return (index >= 0 && index < numQueues) ? &queues[index] : nullptr;
+  }
+  Vst::IParamValueQueue *PLUGIN_API
+  addParameterData(const Vst::ParamID &id, int32 &index) override {
+    for (int32 i = 0; i < numQueues; i++) {
+      if (queues[i].getParameterId() == id) {
+        index = i;
+        return &queues[i];
+      }
+    }
+    if (numQueues >= static_cast<int32>(queues.size()))
+      return nullptr;
+    index = numQueues;
+    queues[numQueues].reset(id);
+    return &queues[numQueues++];
+  }
+
+  void clear() { numQueues = 0; }
+
+private:
+  std::array<FixedParamValueQueue, kNumParams> queues;
+  int32 numQueues = 0;
+};
+
+//------------------------------------------------------------------------
+// Workloads
+//------------------------------------------------------------------------
+struct BlockSetup {
+  FixedEventList events;
+  FixedParameterChanges inputChanges;
+  FixedParameterChanges outputChanges;
+};
+
+using Workload = void (*)(BlockSetup &setup, int block, int32 numSamples);
+
+void emptyBlocks(BlockSetup &, int, int32) {}
+
+void chordChanges(BlockSetup &setup, int block, int32 numSamples) {
+  // Two 10-note chords per block, the first released mid-block
+  int root = 36 + (block % 24);
+  for (int i = 0; i < 10; i++)
+    setup.events.addNote(0, root + i * 4, true);
+  for (int i = 0; i < 10; i++)
+    setup.events.addNote(numSamples / 2, root + i * 4, false);
+  for (int i = 0; i < 10; i++)
+    setup.events.addNote(numSamples / 2, root + 2 + i * 4, true);
+}
+
+void fullKeyboard(BlockSetup &setup, int block, int32 numSamples) {
+  // All 88 keys on, then off again on the next block
+  for (int pitch = 21; pitch <= 108; pitch++)
+    setup.events.addNote((pitch - 21) * numSamples / 88, pitch, block % 2 == 0);
+}
+
+void trillsWithPressure(BlockSetup &setup, int, int32 numSamples) {
+  // Fast alternation interleaved with events that don't affect note state
+  for (int32 offset = 0; offset < numSamples; offset += 8) {
+    int pitch = (offset / 8) % 2 ? 62 : 64;
+    setup.events.addNote(offset, pitch, true);
+    setup.events.addPolyPressure(offset, pitch);
+    setup.events.addNote(offset + 4 < numSamples ? offset + 4 : offset, pitch,
+                         false);
+  }
+}
+
+void parameterChanges(BlockSetup &setup, int block, int32 numSamples) {
+  // Key signature automation, auto key and bypass toggles alongside notes
+  int32 index = 0;
+  if (auto *queue = setup.inputChanges.addParameterData(kAutoKeyParam, index))
+    queue->addPoint(0, (block % 64) < 48 ? 1.0 : 0.0, index);
+  if (auto *queue =
+          setup.inputChanges.addParameterData(kKeySignatureParam, index))
+    queue->addPoint(0, (block % kNumKeySigs) / double(kNumKeySigs - 1), index);
+  if (auto *queue = setup.inputChanges.addParameterData(kBypassParam, index))
+    queue->addPoint(0, (block % 8) == 7 ? 1.0 : 0.0, index);
+  chordChanges(setup, block, numSamples);
+}
+
+//------------------------------------------------------------------------
+struct WorkloadInfo {
+  const char *name;
+  Workload build;
+};
+
+const WorkloadInfo workloads[] = {
+    {"empty blocks", emptyBlocks},
+    {"10-note chord changes", chordChanges},
+    {"88-key clusters", fullKeyboard},
+    {"trills + poly pressure", trillsWithPressure},
+    {"key/auto/bypass automation", parameterChanges},
+};
+
+//------------------------------------------------------------------------
+bool runWorkload(const WorkloadInfo &workload, int32 symbolicSampleSize,
+                 int32 numSamples) {
+  const int kWarmupBlocks = 4;
+  const int kCheckedBlocks = 256;
+
+  auto *processor = new NotationChordHelperProcessor();
+  processor->initialize(nullptr);
+
+  Vst::ProcessSetup setup = {};
+  setup.processMode = Vst::kRealtime;
+  setup.symbolicSampleSize = symbolicSampleSize;
+  setup.maxSamplesPerBlock = numSamples;
+  setup.sampleRate = 48000.0;
+  processor->setupProcessing(setup);
+  processor->setActive(true);
+
+  // Audio buffers large enough for either sample size
+  static double leftBuffer[4096];
+  static double rightBuffer[4096];
+  void *channels[2] = {leftBuffer, rightBuffer};
+  Vst::AudioBusBuffers output;
+  output.numChannels = 2;
+  output.silenceFlags = 0;
+  if (symbolicSampleSize == Vst::kSample64)
+    output.channelBuffers64 = reinterpret_cast<Vst::Sample64 **>(channels);
+  else
+    output.channelBuffers32 = reinterpret_cast<Vst::Sample32 **>(channels);
+
+  Vst::ProcessContext context = {};
+  context.state = Vst::ProcessContext::kContTimeValid |
+                  Vst::ProcessContext::kProjectTimeMusicValid |
+                  Vst::ProcessContext::kTempoValid |
+                  Vst::ProcessContext::kTimeSigValid |
+                  Vst::ProcessContext::kPlaying;
+  context.sampleRate = setup.sampleRate;
+  context.tempo = 120.0;
+  context.timeSigNumerator = 4;
+  context.timeSigDenominator = 4;
+
+  auto *block = new BlockSetup();
+  Violations total;
+  int failedBlocks = 0;
+
+  for (int b = 0; b < kWarmupBlocks + kCheckedBlocks; b++) {
+    block->events.clear();
+    block->inputChanges.clear();
+    block->outputChanges.clear();
+    workload.build(*block, b, numSamples);
+
+    Vst::ProcessData data;
+    data.processMode = setup.processMode;
+    data.symbolicSampleSize = symbolicSampleSize;
+    data.numSamples = numSamples;
+    data.numInputs = 0;
+    data.numOutputs = NOTATION_HELPER_EVENT_ONLY ? 0 : 1;
+    data.inputs = nullptr;
+    data.outputs = &output;
+    data.inputParameterChanges = &block->inputChanges;
+    data.outputParameterChanges = &block->outputChanges;
+    data.inputEvents = &block->events;
+    data.outputEvents = nullptr;
+    data.processContext = &context;
+
+    if (b < kWarmupBlocks) {
+      processor->process(data); // Lets any lazy first-use setup happen
+    } else {
+      RealtimeGuard guard;
+      processor->process(data);
+      Violations v = guard.violations();
+      if (v.any()) {
+        failedBlocks++;
+        total.allocations += v.allocations;
+        total.frees += v.frees;
+        total.locks += v.locks;
+      }
+    }
+
+    context.continousTimeSamples += numSamples;
+    context.projectTimeSamples += numSamples;
+    context.projectTimeMusic += numSamples * context.tempo / 60.0 /
+                                context.sampleRate;
+  }
+
+  processor->setActive(false);
+  processor->terminate();
+  processor->release();
+  delete block;
+
+  bool passed = failedBlocks == 0;
+  std::printf("%-4s %-26s %5d samples  %s", passed ? "ok" : "FAIL",
+              workload.name, numSamples,
+              symbolicSampleSize == Vst::kSample64 ? "64-bit" : "32-bit");
+  if (!passed) {
+    std::printf("  (%d/%d blocks: %d allocations, %d frees, %d locks)",
+                failedBlocks, kCheckedBlocks, total.allocations, total.frees,
+                total.locks);
+  }
+  std::printf("\n");
+  return passed;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+#if RT_CHECK_HOOKS_LIBC
+  resolveLockFunctions();
+#else
+  std::printf("note: malloc/lock interposition unavailable on this platform, "
+              "checking operator new/delete only\n");
+#endif
+
+  const int32 blockSizes[] = {32, 256, 1024};
+  const int32 sampleSizes[] = {Vst::kSample32, Vst::kSample64};
+
+  bool allPassed = true;
+  for (const auto &workload : workloads) {
+    for (int32 sampleSize : sampleSizes) {
+      for (int32 numSamples : blockSizes) {
+        allPassed &= runWorkload(workload, sampleSize, numSamples);
+      }
+    }
+  }
+
+  if (allPassed)
+    std::printf("process() is real-time safe\n");
+  else
+    std::printf("process() allocated or locked on the audio thread\n");
+  return allPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,329 @@
+//------------------------------------------------------------------------
+// Copyright(c) 2025 Paul Ursulean.
+//------------------------------------------------------------------------
+//
+// Delivery order check for the chord timeline and history
+//
+// Hosts hand the processor's output parameters to the controller in their
+// own order: queue by queue as they were added, sorted by parameter ID, or
+// only the last point of each queue. This tool plays chord changes (some
+// of them in the same block) and a loop jump through NoteProcessor,
+// delivers each block's points in each of those orders to what the
+// controller does with them (transition parts through a
+// NoteTransitionAssembler into the history and timeline recorders), and
+// compares the timeline (with its meter) and history with what the played
+// positions and times should give. Only the last change of a block can
+// survive the last-point delivery. Exits non-zero on any difference, or if
+// a queue got points out of offset order.
+//
+//------------------------------------------------------------------------
+
+#include "chord_history.h"
+#include "chord_timeline.h"
+#include "note_processor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Ursulean;
+
+namespace {
+
+// Parameter IDs as in cids.h, which needs the SDK
+enum {
+  kNoteMaskFirstParam = 0,
+  kLocateParam = 13,
+  kTransitionFirstParam = 14
+};
+
+struct Point {
+  int32_t sampleOffset;
+  double value;
+};
+
+struct Queue {
+  int id;
+  std::vector<Point> points;
+};
+
+//------------------------------------------------------------------------
+// Collects a block's points into one queue per parameter, in the order
+// the queues were first added, like a host's IParameterChanges
+class QueueOutput : public ControllerOutput {
+public:
+  bool sendNoteMaskWord(int wordIndex, uint16_t word,
+                        int32_t sampleOffset) override {
+    return addPoint(kNoteMaskFirstParam + wordIndex,
+                    noteMaskWordToNormalized(word), sampleOffset);
+  }
+  bool sendKeySignature(KeySignature, int32_t) override { return true; }
+  bool sendTransition(const NoteTransition &transition,
+                      int32_t sampleOffset) override {
+    for (int part = 0; part < kNumTransitionParts; part++) {
+      if (isTransitionPartSent(transition, part))
+        addPoint(kTransitionFirstParam + part,
+                 transitionPartToNormalized(transition, part), sampleOffset);
+    }
+    return true;
+  }
+  bool sendLocate(double quarters, int32_t sampleOffset) override {
+    return addPoint(kLocateParam, songPositionToNormalized(quarters),
+                    sampleOffset);
+  }
+
+  std::vector<Queue> queues;
+  int misorderedPoints = 0;
+
+private:
+  bool addPoint(int id, double value, int32_t sampleOffset) {
+    auto queue = std::find_if(queues.begin(), queues.end(),
+                              [id](const Queue &q) { return q.id == id; });
+    if (queue == queues.end())
+      queue = queues.insert(queues.end(), Queue{id, {}});
+    else if (sampleOffset <= queue->points.back().sampleOffset)
+      misorderedPoints++; // Offsets have to increase within a queue
+    queue->points.push_back({sampleOffset, value});
+    return true;
+  }
+};
+
+//------------------------------------------------------------------------
+// What NotationChordHelperController::setParamNormalized() does with them
+class ControllerStandIn {
+public:
+  ControllerStandIn()
+      : historyRecorder(history), timelineRecorder(timeline) {}
+
+  void setParam(int id, double value) {
+    int part = id - kTransitionFirstParam;
+    if (part >= 0 && part < kNumTransitionParts &&
+        assembler.add(part, value)) {
+      historyRecorder.add(assembler.getTransition());
+      timelineRecorder.add(assembler.getTransition());
+    }
+  }
+
+  ChordHistory history;
+  ChordTimeline timeline;
+
+private:
+  NoteTransitionAssembler assembler;
+  ChordHistoryRecorder historyRecorder;
+  ChordTimelineRecorder timelineRecorder;
+};
+
+enum class Delivery { kQueueOrder, kIdOrder, kReverseIdOrder, kLastPoints };
+
+void deliver(std::vector<Queue> queues, Delivery delivery,
+             ControllerStandIn &controller) {
+  auto byId = [](const Queue &a, const Queue &b) { return a.id < b.id; };
+  if (delivery == Delivery::kIdOrder || delivery == Delivery::kLastPoints)
+    std::stable_sort(queues.begin(), queues.end(), byId);
+  if (delivery == Delivery::kReverseIdOrder) {
+    std::stable_sort(queues.begin(), queues.end(), byId);
+    std::reverse(queues.begin(), queues.end());
+  }
+
+  for (const Queue &queue : queues) {
+    if (delivery == Delivery::kLastPoints) {
+      controller.setParam(queue.id, queue.points.back().value);
+      continue;
+    }
+    for (const Point &point : queue.points)
+      controller.setParam(queue.id, point.value);
+  }
+}
+
+//------------------------------------------------------------------------
+// The song: chord changes at block offsets, with a loop back to the start
+struct Change {
+  int block;
+  int32_t sampleOffset;
+  std::vector<int> pitches; // Empty for a rest
+};
+
+const double kSampleRate = 48000.0;
+const int32_t kBlockSize = 512;
+const double kTempo = 96.0;
+const int32_t kBeatsPerBar = 8; // Of eighths, four quarters a bar
+const int32_t kBeatUnit = 8;
+const int kLoopBlock = 300; // Jumps back to the start here
+const int kNumBlocks = 500;
+
+const std::vector<Change> song = {
+    {2, 100, {48, 52, 55}},
+    {40, 0, {53, 57, 60}},
+    {80, 511, {43, 55, 59, 62, 65}},      // Spans two mask words
+    {120, 37, {}},                        // Rest
+    {160, 255, {33, 45, 57, 60, 64, 76}}, // Four words
+    {200, 1, {48, 52, 55, 59}},
+    {240, 10, {45, 48, 52}}, // Three changes in one block
+    {240, 200, {47, 50, 53, 57}},
+    {240, 400, {}},
+    // Second pass after the loop
+    {kLoopBlock, 0, {50, 53, 57}},
+    {kLoopBlock + 60, 300, {43, 47, 50, 53}},
+    {kLoopBlock + 150, 20, {48, 52, 55}},
+};
+
+double blockPosition(int block) {
+  int passBlock = block < kLoopBlock ? block : block - kLoopBlock;
+  return passBlock * kBlockSize * kTempo / (60.0 * kSampleRate);
+}
+
+const double kQuartersPerBar = kBeatsPerBar * 4.0 / kBeatUnit;
+
+int32_t barAt(double position) {
+  return static_cast<int32_t>(position / kQuartersPerBar);
+}
+
+NoteMask maskOf(const std::vector<int> &pitches) {
+  NoteMask mask;
+  for (int pitch : pitches)
+    mask.set(pitch);
+  return mask;
+}
+
+// What a controller that saw every change in order would hold, or only the
+// last one of each block
+struct Expected {
+  ChordHistory history;
+  ChordTimeline timeline;
+};
+
+void expectedResult(bool lastOfBlockOnly, Expected &expected) {
+  NoteMask sounding;
+  double soundingSince = 0.0;
+  for (size_t i = 0; i < song.size(); i++) {
+    const Change &change = song[i];
+    if (lastOfBlockOnly && i + 1 < song.size() &&
+        song[i + 1].block == change.block)
+      continue;
+    if (change.block == kLoopBlock)
+      expected.timeline.breakRecording();
+    double position = blockPosition(change.block) +
+                      change.sampleOffset * kTempo / (60.0 * kSampleRate);
+    expected.timeline.record(position, barAt(position),
+                             maskOf(change.pitches), kCMajor);
+    expected.timeline.setMeter({kBeatsPerBar, kBeatUnit, kTempo});
+
+    // Every release ends a chord, however short
+    NoteMask notes = maskOf(change.pitches);
+    double time = (int64_t(change.block) * kBlockSize + change.sampleOffset) /
+                  kSampleRate;
+    if ((sounding & (sounding ^ notes)).any())
+      expected.history.push(
+          {sounding, kCMajor, soundingSince, time - soundingSince});
+    sounding = notes;
+    soundingSince = time;
+  }
+}
+
+void playSong(Delivery delivery, ControllerStandIn &controller,
+              int &misorderedPoints) {
+  NoteProcessor processor;
+  processor.setSampleRate(kSampleRate);
+  QueueOutput output;
+  std::vector<int> sounding;
+
+  for (int b = 0; b < kNumBlocks; b++) {
+    MusicalTime time;
+    time.position = blockPosition(b);
+    time.tempo = kTempo;
+    time.bar = barAt(time.position);
+    time.barStart = time.bar * kQuartersPerBar;
+    time.quartersPerBar = kQuartersPerBar;
+    time.beatsPerBar = kBeatsPerBar;
+    time.beatUnit = kBeatUnit;
+    time.isPlaying = true;
+
+    output.queues.clear();
+    processor.beginBlock(kBlockSize, true, int64_t(b) * kBlockSize, &output,
+                         &time);
+    for (const Change &change : song) {
+      if (change.block != b)
+        continue;
+      for (int pitch : sounding)
+        processor.addNote({change.sampleOffset, pitch, 0.f, 0, false});
+      for (int pitch : change.pitches)
+        processor.addNote({change.sampleOffset, pitch, 0.8f, 0, true});
+      sounding = change.pitches;
+    }
+    processor.endBlock();
+
+    deliver(output.queues, delivery, controller);
+  }
+  misorderedPoints = output.misorderedPoints;
+}
+
+bool sameTimeline(const ChordTimeline &a, const ChordTimeline &b) {
+  const TimelineMeter &meterA = a.getMeter();
+  const TimelineMeter &meterB = b.getMeter();
+  if (a.size() != b.size() || meterA.beatsPerBar != meterB.beatsPerBar ||
+      meterA.beatUnit != meterB.beatUnit ||
+      std::abs(meterA.tempo - meterB.tempo) > 1e-3)
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    const TimelineChord &x = a.getChord(i);
+    const TimelineChord &y = b.getChord(i);
+    if (x.notes != y.notes || x.bar != y.bar ||
+        std::abs(x.position - y.position) > 1e-6)
+      return false;
+  }
+  return true;
+}
+
+bool sameHistory(const ChordHistory &a, const ChordHistory &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t age = 0; age < a.size(); age++) {
+    const ChordSnapshot &x = a.getRecent(age);
+    const ChordSnapshot &y = b.getRecent(age);
+    // Times travel in whole microseconds
+    if (x.notes != y.notes || std::abs(x.time - y.time) > 1e-6 ||
+        std::abs(x.duration - y.duration) > 2e-6)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+int main() {
+  struct {
+    const char *name;
+    Delivery delivery;
+  } const deliveries[] = {
+      {"queue order", Delivery::kQueueOrder},
+      {"ID order", Delivery::kIdOrder},
+      {"reverse ID order", Delivery::kReverseIdOrder},
+      {"last point per queue", Delivery::kLastPoints},
+  };
+
+  int failures = 0;
+  for (const auto &d : deliveries) {
+    Expected expected;
+    expectedResult(d.delivery == Delivery::kLastPoints, expected);
+    ControllerStandIn played;
+    int misorderedPoints = 0;
+    playSong(d.delivery, played, misorderedPoints);
+    bool passed = sameTimeline(played.timeline, expected.timeline) &&
+                  sameHistory(played.history, expected.history) &&
+                  misorderedPoints == 0;
+    std::printf("%-4s %-22s %zu/%zu chords, %zu/%zu in history",
+                passed ? "ok" : "FAIL", d.name, played.timeline.size(),
+                expected.timeline.size(), played.history.size(),
+                expected.history.size());
+    if (misorderedPoints)
+      std::printf("  (%d points out of offset order)", misorderedPoints);
+    std::printf("\n");
+    if (!passed)
+      failures++;
+  }
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}